@@ -1452,6 +1452,7 @@ boolean buildAMachine(enum machineTypes bp,
                     }
                     if (terrainSucceeded) {
                         pmap[featX][featY].layers[feature->layer] = feature->terrain;
+                        markActiveTile(featX, featY);
                     }
                 }
 
@@ -1832,6 +1833,7 @@ static void runAutogenerators(boolean buildAreaMachines) {
 
                             // Build!
                             pmapAt(foundationLoc)->layers[gen->layer] = gen->terrain;
+                            markActiveTile(foundationLoc.x, foundationLoc.y);
 
                             if (D_INSPECT_LEVELGEN) {
                                 dumpLevelToScreen();
@@ -3008,11 +3010,21 @@ void updateMapToShore() {
     freeGrid(costMap);
 }
 
-// Calculates the distance map for the given waypoint.
-// This is called on all waypoints during setUpWaypoints(),
-// and then one waypoint is recalculated per turn thereafter.
-void refreshWaypoint(short wpIndex) {
+// A waypoint's distance map depends only on where the waypoint is and on the cost map, which changes
+// only when the terrain does or a monster falls asleep, wakes up or is captured. The rolling refresh
+// in playerTurnEnded() comes back to each waypoint every few dozen turns, so most of the time the
+// map it would calculate is the one it already has. The cost map is kept here, with a version number
+// that changes whenever the cost map does, and a waypoint's map is calculated again only if it was
+// made for another location or version.
+static short waypointCosts[DCOLS][DROWS];
+static unsigned long waypointCostVersion = 0;
+static unsigned long waypointMapVersion[MAX_WAYPOINT_COUNT];    // 0 if the map must be calculated
+static pos waypointMapLoc[MAX_WAYPOINT_COUNT];
+
+static void updateWaypointCosts() {
     short **costMap;
+    boolean changed = false;
+    short i, j;
 
     costMap = allocGrid();
     populateGenericCostMap(costMap);
@@ -3024,10 +3036,48 @@ void refreshWaypoint(short wpIndex) {
             costMap[monst->loc.x][monst->loc.y] = PDS_FORBIDDEN;
         }
     }
+    for (i=0; i<DCOLS; i++) {
+        for (j=0; j<DROWS; j++) {
+            if (waypointCosts[i][j] != costMap[i][j]) {
+                waypointCosts[i][j] = costMap[i][j];
+                changed = true;
+            }
+        }
+    }
+    if (changed || !waypointCostVersion) {
+        waypointCostVersion++;
+    }
+    freeGrid(costMap);
+}
+
+static void calculateWaypointMap(short wpIndex) {
+    short **costMap;
+    short i, j;
+
+    if (waypointMapVersion[wpIndex] == waypointCostVersion
+        && posEq(waypointMapLoc[wpIndex], rogue.wpCoordinates[wpIndex])) {
+        return; // it would come out the same
+    }
+    costMap = allocGrid();
+    for (i=0; i<DCOLS; i++) {
+        for (j=0; j<DROWS; j++) {
+            costMap[i][j] = waypointCosts[i][j];
+        }
+    }
     fillGrid(rogue.wpDistance[wpIndex], 30000);
     rogue.wpDistance[wpIndex][rogue.wpCoordinates[wpIndex].x][rogue.wpCoordinates[wpIndex].y] = 0;
     dijkstraScan(rogue.wpDistance[wpIndex], costMap, true);
     freeGrid(costMap);
+    waypointMapVersion[wpIndex] = waypointCostVersion;
+    waypointMapLoc[wpIndex] = rogue.wpCoordinates[wpIndex];
+}
+
+// Brings the distance map for the given waypoint up to date.
+// setUpWaypoints() calculates all of them, and then one waypoint
+// is refreshed per turn thereafter.
+void refreshWaypoint(short wpIndex) {
+    updateWaypointCosts();
+    calculateWaypointMap(wpIndex);
 }
 
 void setUpWaypoints() {
@@ -3061,8 +3111,13 @@ void setUpWaypoints() {
         }
     }
 
+    // Every waypoint is new, and the distance maps may have been reallocated for a new game.
+    for (i=0; i<MAX_WAYPOINT_COUNT; i++) {
+        waypointMapVersion[i] = 0;
+    }
+    updateWaypointCosts();
     for (i=0; i<rogue.wpCount; i++) {
-        refreshWaypoint(i);
+        calculateWaypointMap(i);
 //        blackOutScreen();
 //        dumpLevelToScreen();
 //        displayGrid(rogue.wpDistance[i]);
@@ -3244,6 +3299,7 @@ boolean fillSpawnMap(enum dungeonLayers layer,
                 }
 
                 pmap[i][j].layers[layer] = surfaceTileType; // Place the terrain!
+                markActiveTile(i, j);
                 accomplishedSomething = true;
 
                 if (refresh) {
@@ -3384,6 +3440,7 @@ boolean spawnDungeonFeature(short x, short y, dungeonFeature *feat, boolean refr
         if (feat->layer == GAS) {
             pmap[x][y].volume += feat->startProbability;
             pmap[x][y].layers[GAS] = feat->tile;
+            markActiveTile(x, y);
             if (refreshCell) {
                 refreshDungeonCell((pos){ x, y });
             }
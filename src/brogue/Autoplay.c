@@ -0,0 +1,197 @@
+/*
+ *  Autoplay.c
+ *  Brogue
+ *
+ *  This file is part of Brogue.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Unattended games for balance statistics. Each game is played by the same autopilot as the
+// in-game 'A' command (explore, fight whatever is adjacent, take the stairs down), and one CSV
+// line is written per game. Nothing is drawn, saved or added to the high scores.
+//
+// Recordings are checked the same way: each is replayed without a display and one CSV line reports
+// how it ended, how fast it played and, if it went out of sync, on which turn. It also counts the
+// cost maps built for the whole level each turn and how many cells' terrain flags had to be read
+// for them; without the terrain snapshot every cost map would read all DCOLS * DROWS cells.
+
+#include "Rogue.h"
+#include "GlobalsBase.h"
+#include "Globals.h"
+#include <time.h>
+
+#define AUTOPLAY_CSV_HEADER     "variant,seed,outcome,cause,depth,deepest_depth,turns,gold,items_found"
+#define AUTOPLAY_TURN_LIMIT     200000  // a game still running after this many turns is recorded as "turn limit"
+#define AUTOPLAY_STALL_LIMIT    20      // give up after this many searches in a row that don't let us explore further
+#define AUTOPLAY_SEARCH_TURNS   5       // a full five-turn search, the last one of which is a strong one
+#define VERIFY_CSV_HEADER       "file,result,outcome,detail,depth,turns,seconds,turns_per_second,oos_turn,cost_maps_per_turn,terrain_reads_per_turn"
+
+static char autoplayOutcome[20];
+static char autoplayCause[COLS];
+
+// Called by gameOver() and victory() instead of their usual screens when autoplayBatch is set.
+void noteAutoplayOutcome(const char *outcome, const char *cause) {
+    strncpy(autoplayOutcome, outcome, sizeof(autoplayOutcome) - 1);
+    autoplayOutcome[sizeof(autoplayOutcome) - 1] = '\0';
+    strncpy(autoplayCause, cause, sizeof(autoplayCause) - 1);
+    autoplayCause[sizeof(autoplayCause) - 1] = '\0';
+}
+
+// Writes text as a quoted CSV field, on one line whatever it contains.
+static void printCsvText(FILE *stream, const char *text) {
+    fputc('"', stream);
+    for (; *text; text++) {
+        if (*text == '"') {
+            fputs("\"\"", stream);
+        } else {
+            fputc((unsigned char) *text < ' ' ? ' ' : *text, stream);
+        }
+    }
+    fputc('"', stream);
+}
+
+void printAutoplayCsvHeader(FILE *stream) {
+    fprintf(stream, "%s\n", AUTOPLAY_CSV_HEADER);
+}
+
+static void autoplayGame(uint64_t seed, FILE *stream) {
+    short stalls = 0, i;
+
+    rogue.nextGamePath[0] = '\0';
+    randomNumbersGenerated = 0;
+
+    rogue.playbackMode = false;
+    rogue.playbackFastForward = false;
+    rogue.playbackBetweenTurns = false;
+
+    currentFilePath[0] = '\0'; // no recording
+    autoplayOutcome[0] = '\0';
+    autoplayCause[0] = '\0';
+
+    initializeRogue(seed);
+    rogue.playbackFastForward = true; // skips drawing, exactly as when fast-forwarding a recording
+    startLevel(rogue.depthLevel, 1);
+
+    while (!rogue.gameHasEnded
+           && rogue.playerTurnNumber < AUTOPLAY_TURN_LIMIT
+           && stalls < AUTOPLAY_STALL_LIMIT) {
+
+        rogue.autoPlayingLevel = true; // also answers any confirmation prompts with yes
+        if (explore(1)) {
+            stalls = 0;
+        } else if (posEq(player.loc, rogue.downLoc)) {
+            useStairs(1);
+            stalls = 0;
+        } else {
+            // Nowhere left to explore and no known way down (or confused, or stuck): look for secrets.
+            stalls++;
+            for (i = 0; i < AUTOPLAY_SEARCH_TURNS && !rogue.gameHasEnded; i++) {
+                manualSearch();
+            }
+        }
+    }
+    rogue.autoPlayingLevel = false;
+
+    if (!rogue.gameHasEnded) {
+        noteAutoplayOutcome(rogue.playerTurnNumber >= AUTOPLAY_TURN_LIMIT ? "turn limit" : "stalled", "");
+    }
+
+    fprintf(stream, "%s,%llu,%s,",
+            gameConst->variantName,
+            (unsigned long long) seed,
+            autoplayOutcome);
+    printCsvText(stream, autoplayCause);
+    fprintf(stream, ",%i,%i,%lu,%lu,%lu\n",
+            rogue.depthLevel,
+            rogue.deepestLevel,
+            rogue.playerTurnNumber,
+            rogue.gold,
+            rogue.itemsFound);
+    fflush(stream);
+
+    rogue.playbackFastForward = false;
+    freeEverything();
+}
+
+// Plays the seeds firstSeed, firstSeed + stride, ... up to lastSeed, writing one CSV line each.
+// Returns the number of games played.
+uint64_t autoplaySeeds(uint64_t firstSeed, uint64_t lastSeed, uint64_t stride, FILE *stream) {
+    uint64_t seed, games = 0;
+
+    rogue.nextGame = NG_NOTHING;
+    initializeGameVariant();
+
+    for (seed = firstSeed; seed <= lastSeed && seed >= firstSeed; seed += stride) {
+        autoplayGame(seed, stream);
+        games++;
+    }
+    return games;
+}
+
+void printVerifyCsvHeader(FILE *stream) {
+    fprintf(stream, "%s\n", VERIFY_CSV_HEADER);
+}
+
+// Replays one recording or saved game and writes its CSV line. A recording passes if it plays
+// through to its recorded ending, or to the end of the file for a saved game, without going out
+// of sync. Expects autoplayBatch and nonInteractivePlayback to be set.
+boolean verifyRecording(const char *path, FILE *stream) {
+    const clock_t start = clock();
+    boolean opened, passed;
+    char oosTurn[20] = "";
+    double seconds;
+
+    rogue.nextGame = NG_NOTHING;
+    initializeGameVariant();
+    autoplayOutcome[0] = '\0';
+    autoplayCause[0] = '\0';
+    rogue.gameExitStatusCode = EXIT_STATUS_SUCCESS;
+    costMapCounts.costMaps = costMapCounts.terrainReads = 0;
+
+    opened = playRecordingHeadless(path);
+    if (!opened) {
+        noteAutoplayOutcome("unreadable", "");
+    } else if (!autoplayOutcome[0]) {
+        noteAutoplayOutcome("stopped", "");
+    }
+    passed = (opened
+              && rogue.gameExitStatusCode == EXIT_STATUS_SUCCESS
+              && strcmp(autoplayOutcome, "stopped"));
+    if (opened && rogue.playbackOOS && rogue.gameExitStatusCode == EXIT_STATUS_FAILURE_RECORDING_OOS) {
+        sprintf(oosTurn, "%lu", rogue.playerTurnNumber);
+    }
+    seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+    printCsvText(stream, path);
+    fprintf(stream, ",%s,%s,", passed ? "passed" : "failed", autoplayOutcome);
+    printCsvText(stream, autoplayCause);
+    fprintf(stream, ",%i,%lu,%.3f,%.0f,%s,%.1f,%.0f\n",
+            opened ? rogue.depthLevel : 0,
+            opened ? rogue.playerTurnNumber : 0,
+            seconds,
+            seconds > 0 ? rogue.playerTurnNumber / seconds : 0.0,
+            oosTurn,
+            opened && rogue.playerTurnNumber ? (double) costMapCounts.costMaps / rogue.playerTurnNumber : 0.0,
+            opened && rogue.playerTurnNumber ? (double) costMapCounts.terrainReads / rogue.playerTurnNumber : 0.0);
+    fflush(stream);
+
+    if (opened) {
+        freeEverything();
+        releasePlaybackFile();
+    }
+    rogue.playbackMode = false;
+    rogue.playbackFastForward = false;
+    return passed;
+}
@@ -206,6 +206,140 @@ void dijkstraScan(short **distanceMap, short **costMap, boolean useDiagonals) {
     pdsBatchOutput(&map, distanceMap, useDiagonals);
 }
 
+// Every function that builds a cost map for the whole level used to ask each cell about its terrain
+// flags afresh, several times over. They now read them from this snapshot, which keeps a copy of
+// each cell's terrain layers and works the flags out again only for the cells where those have
+// changed since the last cost map, whenever that was.
+static terrainSnapshot terrain;
+static unsigned long terrainReadSerial = 0;
+
+// Brings the snapshot up to date with pmap. Call once for each cost map built.
+const terrainSnapshot *currentTerrain() {
+    enum dungeonLayers layer;
+    short i, j;
+
+    costMapCounts.costMaps++;
+    for (i=0; i<DCOLS; i++) {
+        for (j=0; j<DROWS; j++) {
+            for (layer = 0; layer < NUMBER_TERRAIN_LAYERS; layer++) {
+                if (terrain.layers[i][j][layer] != pmap[i][j].layers[layer]) {
+                    break;
+                }
+            }
+            if (layer < NUMBER_TERRAIN_LAYERS || !terrain.readAt[i][j]) {
+                for (layer = 0; layer < NUMBER_TERRAIN_LAYERS; layer++) {
+                    terrain.layers[i][j][layer] = pmap[i][j].layers[layer];
+                }
+                terrain.flags[i][j] = terrainFlags((pos){ i, j });
+                terrain.mechFlags[i][j] = terrainMechFlags((pos){ i, j });
+                terrain.discoveredFlags[i][j] = discoveredTerrainFlagsAtLoc((pos){ i, j });
+                terrain.readAt[i][j] = ++terrainReadSerial;
+                costMapCounts.terrainReads++;
+            }
+        }
+    }
+    return &terrain;
+}
+
+// The part of calculateDistances()'s cost map that comes from terrain alone, for one combination of
+// its flags. Each entry notes when the snapshot last read each cell (and, when pathing for the
+// player, whether the cell had been discovered) and rebuilds only the cells that have changed since.
+// Monsters pathing with the same flags on the same turn, and often over many turns, then share one
+// cost map.
+#define TERRAIN_COST_CACHE_SIZE 4
+
+typedef struct terrainCostMap {
+    boolean inUse;
+    unsigned long blockingTerrainFlags;
+    boolean canUseSecretDoors;
+    boolean forPlayer;
+    unsigned long lastUsed;
+    unsigned long readAt[DCOLS][DROWS];             // the snapshot's readAt when the cell was built
+    boolean known[DCOLS][DROWS];                    // DISCOVERED or MAGIC_MAPPED, if forPlayer
+    signed char cost[DCOLS][DROWS];
+    boolean open[DCOLS][DROWS];                     // cost is up to the traveler's monsterAvoids()
+} terrainCostMap;
+
+static terrainCostMap terrainCostCache[TERRAIN_COST_CACHE_SIZE];
+static unsigned long terrainCostCacheUses = 0;
+
+static void updateTerrainCost(terrainCostMap *entry, short i, short j) {
+    const unsigned long flags = terrain.flags[i][j];
+
+    entry->readAt[i][j] = terrain.readAt[i][j];
+    entry->known[i][j] = (entry->forPlayer && (pmap[i][j].flags & (DISCOVERED | MAGIC_MAPPED)));
+    entry->open[i][j] = false;
+
+    if (entry->canUseSecretDoors
+        && (terrain.mechFlags[i][j] & TM_IS_SECRET)
+        && (flags & T_OBSTRUCTS_PASSABILITY)
+        && !(terrain.discoveredFlags[i][j] & T_OBSTRUCTS_PASSABILITY)) {
+
+        entry->cost[i][j] = 1;
+    } else if ((flags & T_OBSTRUCTS_PASSABILITY)
+               || (entry->forPlayer && !entry->known[i][j])) {
+
+        entry->cost[i][j] = (flags & T_OBSTRUCTS_DIAGONAL_MOVEMENT) ? PDS_OBSTRUCTION : PDS_FORBIDDEN;
+    } else {
+        entry->open[i][j] = true;
+        entry->cost[i][j] = (flags & entry->blockingTerrainFlags) ? PDS_FORBIDDEN : 1;
+    }
+}
+
+static boolean terrainCostIsCurrent(const terrainCostMap *entry, short i, short j) {
+    return (entry->readAt[i][j] == terrain.readAt[i][j]
+            && (!entry->forPlayer || entry->known[i][j] == !!(pmap[i][j].flags & (DISCOVERED | MAGIC_MAPPED))));
+}
+
+// Returns the cached terrain costs for these flags, brought up to date with the map.
+static terrainCostMap *terrainCosts(unsigned long blockingTerrainFlags, boolean canUseSecretDoors, boolean forPlayer) {
+    terrainCostMap *entry = NULL;
+    short i, j, k;
+
+    currentTerrain();
+
+    for (k = 0; k < TERRAIN_COST_CACHE_SIZE; k++) {
+        if (terrainCostCache[k].inUse
+            && terrainCostCache[k].blockingTerrainFlags == blockingTerrainFlags
+            && terrainCostCache[k].canUseSecretDoors == canUseSecretDoors
+            && terrainCostCache[k].forPlayer == forPlayer) {
+
+            entry = &terrainCostCache[k];
+            break;
+        }
+    }
+
+    if (entry) {
+        for (i=0; i<DCOLS; i++) {
+            for (j=0; j<DROWS; j++) {
+                if (!terrainCostIsCurrent(entry, i, j)) {
+                    updateTerrainCost(entry, i, j);
+                }
+            }
+        }
+    } else {
+        // Replace the entry that has gone unused the longest.
+        entry = &terrainCostCache[0];
+        for (k = 1; k < TERRAIN_COST_CACHE_SIZE; k++) {
+            if (!terrainCostCache[k].inUse
+                || (entry->inUse && terrainCostCache[k].lastUsed < entry->lastUsed)) {
+                entry = &terrainCostCache[k];
+            }
+        }
+        entry->inUse = true;
+        entry->blockingTerrainFlags = blockingTerrainFlags;
+        entry->canUseSecretDoors = canUseSecretDoors;
+        entry->forPlayer = forPlayer;
+        for (i=0; i<DCOLS; i++) {
+            for (j=0; j<DROWS; j++) {
+                updateTerrainCost(entry, i, j);
+            }
+        }
+    }
+    entry->lastUsed = ++terrainCostCacheUses;
+    return entry;
+}
+
 void calculateDistances(short **distanceMap,
                         short destinationX, short destinationY,
                         unsigned long blockingTerrainFlags,
@@ -213,6 +347,7 @@ void calculateDistances(short **distanceMap,
                         boolean canUseSecretDoors,
                         boolean eightWays) {
     static pdsMap map;
+    const terrainCostMap *costs = terrainCosts(blockingTerrainFlags, canUseSecretDoors, traveler && traveler == &player);
 
     for (int i=0; i<DCOLS; i++) {
         for (int j=0; j<DROWS; j++) {
@@ -224,20 +359,11 @@ void calculateDistances(short **distanceMap,
 
                 // Always avoid damage-immune stationary monsters.
                 cost = PDS_FORBIDDEN;
-            } else if (canUseSecretDoors
-                && cellHasTMFlag((pos){ i, j }, TM_IS_SECRET)
-                && cellHasTerrainFlag((pos){ i, j }, T_OBSTRUCTS_PASSABILITY)
-                && !(discoveredTerrainFlagsAtLoc((pos){ i, j }) & T_OBSTRUCTS_PASSABILITY)) {
-
-                cost = 1;
-            } else if (cellHasTerrainFlag((pos){ i, j }, T_OBSTRUCTS_PASSABILITY)
-                       || (traveler && traveler == &player && !(pmap[i][j].flags & (DISCOVERED | MAGIC_MAPPED)))) {
-
-                cost = cellHasTerrainFlag((pos){ i, j }, T_OBSTRUCTS_DIAGONAL_MOVEMENT) ? PDS_OBSTRUCTION : PDS_FORBIDDEN;
-            } else if ((traveler && monsterAvoids(traveler, (pos){i, j})) || cellHasTerrainFlag((pos){ i, j }, blockingTerrainFlags)) {
+            } else if (costs->open[i][j] && costs->cost[i][j] == 1
+                       && traveler && monsterAvoids(traveler, (pos){i, j})) {
                 cost = PDS_FORBIDDEN;
             } else {
-                cost = 1;
+                cost = costs->cost[i][j];
             }
 
             PDS_CELL(&map, i, j)->cost = cost;
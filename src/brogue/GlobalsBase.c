@@ -70,6 +70,10 @@ unsigned long randomNumbersGenerated;
 unsigned long positionInPlaybackFile;
 unsigned long lengthOfPlaybackFile;
 unsigned long recordingLocation;
+unsigned long recordingStreamBufferSize = RECORDING_STREAM_BUFFER;
+enum recordingSyncPolicies recordingSyncPolicy = RECORDING_SYNC_LEVEL;
+enum stateHashPolicies stateHashPolicy = STATE_HASHES_OFF;
+costMapCounters costMapCounts;
 unsigned long maxLevelChanges;
 char annotationPathname[BROGUE_FILENAME_MAX];   // pathname of annotation file
 uint64_t previousGameSeed;
@@ -91,6 +91,10 @@ extern unsigned short locationInRecordingBuffer;
 extern unsigned long positionInPlaybackFile;
 extern unsigned long lengthOfPlaybackFile;
 extern unsigned long recordingLocation;
+extern unsigned long recordingStreamBufferSize;
+extern enum recordingSyncPolicies recordingSyncPolicy;
+extern enum stateHashPolicies stateHashPolicy;
+extern costMapCounters costMapCounts;
 extern unsigned long maxLevelChanges;
 extern char annotationPathname[BROGUE_FILENAME_MAX];    // pathname of annotation file
 extern uint64_t previousGameSeed;
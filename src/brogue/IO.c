@@ -306,6 +306,16 @@ static short actionMenu(short x, boolean playingBack) {
         buttons[buttonCount].hotkey[0] = STEALTH_RANGE_KEY;
         takeActionOurselves[buttonCount] = true;
         buttonCount++;
+        if (!playingBack) {
+            if (KEYBOARD_LABELS) {
+                sprintf(buttons[buttonCount].text, "  %s[: %s[%s] Instant travel  ", yellowColorEscape, whiteColorEscape, rogue.instantTravel ? "X" : " ");
+            } else {
+                sprintf(buttons[buttonCount].text, "  [%s] Instant travel  ",   rogue.instantTravel ? "X" : " ");
+            }
+            buttons[buttonCount].hotkey[0] = INSTANT_TRAVEL_KEY;
+            takeActionOurselves[buttonCount] = true;
+            buttonCount++;
+        }
 
         if (hasGraphics) {
             if (KEYBOARD_LABELS) {
@@ -906,15 +916,242 @@ void refreshScreen() {
     }
 }
 
+// Appearance cache for displayLevel(). Between two full redraws most cells look
+// exactly the same, so each cell keeps the appearance it was last drawn with and a
+// fingerprint of everything getCellAppearance() reads for it: terrain, gas volume,
+// light, cell flags, remembered appearance, the creature and item on it, and the
+// glyph below it (for wall tops). A cell is recomputed only when it is in the
+// dirty set or its fingerprint has changed; everything else is replotted from
+// the cache. refreshDungeonCell() adds to the dirty set, so every terrain, item,
+// creature, light and visibility change that redraws a cell also invalidates it.
+// State that affects every cell at once (true color mode, omniscience, telepathy,
+// being underwater...) is folded into a display signature, and a change of
+// signature marks the whole map dirty.
+
+typedef struct cellAppearance {
+    enum displayGlyph character;
+    color foreColor;
+    color backColor;
+} cellAppearance;
+
+static cellAppearance cachedAppearance[DCOLS][DROWS];
+static uint64_t cachedFingerprint[DCOLS][DROWS];
+static uint32_t dirtyCells[(DCOLS * DROWS + 31) / 32];
+static uint64_t cachedDisplaySignature;
+
+static boolean cellIsDirty(pos loc) {
+    const int index = loc.x * DROWS + loc.y;
+    return (dirtyCells[index / 32] & (1u << (index % 32))) != 0;
+}
+
+static void markCellClean(pos loc) {
+    const int index = loc.x * DROWS + loc.y;
+    dirtyCells[index / 32] &= ~(1u << (index % 32));
+}
+
+static void markCellDirty(pos loc) {
+    const int index = loc.x * DROWS + loc.y;
+    dirtyCells[index / 32] |= (1u << (index % 32));
+}
+
+static void markAllCellsDirty() {
+    memset(dirtyCells, 0xFF, sizeof(dirtyCells));
+}
+
+static uint64_t mixFingerprint(uint64_t hash, uint64_t value) {
+    hash = (hash ^ value) * 0x9E3779B97F4A7C15ULL;
+    return hash ^ (hash >> 29);
+}
+
+static uint64_t itemFingerprint(uint64_t hash, const item *theItem) {
+    if (!theItem) {
+        return mixFingerprint(hash, 0);
+    }
+    hash = mixFingerprint(hash, (uintptr_t) theItem);
+    hash = mixFingerprint(hash, (uintptr_t) theItem->foreColor);
+    hash = mixFingerprint(hash, theItem->flags);
+    hash = mixFingerprint(hash, (uint64_t) theItem->category << 32 | (uint16_t) theItem->kind << 16 | (uint16_t) theItem->quantity);
+    hash = mixFingerprint(hash, (uint64_t) theItem->displayChar << 48 | (uint64_t) (uint16_t) theItem->originDepth << 32
+                          | (uint16_t) theItem->enchant1 << 16 | (uint16_t) theItem->charges);
+    return hash;
+}
+
+static uint64_t creatureFingerprint(uint64_t hash, const creature *monst) {
+    if (!monst) {
+        return mixFingerprint(hash, 0);
+    }
+    hash = mixFingerprint(hash, (uintptr_t) monst);
+    hash = mixFingerprint(hash, (uintptr_t) monst->info.foreColor);
+    hash = mixFingerprint(hash, (uintptr_t) monst->leader);
+    hash = mixFingerprint(hash, monst->info.flags);
+    hash = mixFingerprint(hash, monst->bookkeepingFlags);
+    hash = mixFingerprint(hash, (uint64_t) monst->info.displayChar << 32 | monst->creatureState << 8
+                          | (monst->info.isLarge ? 4 : 0)
+                          | (monst->status[STATUS_INVISIBLE] ? 2 : 0)
+                          | (monst->status[STATUS_ENTRANCED] ? 1 : 0));
+    return itemFingerprint(hash, monst->carriedItem);
+}
+
+// Everything getCellAppearance() reads for this cell, apart from the display signature.
+static uint64_t cellFingerprint(pos loc, const creature *monst, const item *theItem) {
+    const pcell *cell = pmapAt(loc);
+    uint64_t hash = 0xCBF29CE484222325ULL;
+
+    hash = mixFingerprint(hash, cell->flags);
+    hash = mixFingerprint(hash, (uint64_t) cell->layers[DUNGEON] << 48 | (uint64_t) cell->layers[LIQUID] << 32
+                          | cell->layers[SURFACE] << 16 | cell->layers[GAS]);
+    hash = mixFingerprint(hash, (uint64_t) cell->volume << 48 | (uint64_t) (uint16_t) tmap[loc.x][loc.y].light[0] << 32
+                          | (uint16_t) tmap[loc.x][loc.y].light[1] << 16 | (uint16_t) tmap[loc.x][loc.y].light[2]);
+    hash = mixFingerprint(hash, (uint64_t) cell->rememberedAppearance.character << 48
+                          | (uint64_t) (uint8_t) cell->rememberedAppearance.foreColorComponents[0] << 40
+                          | (uint64_t) (uint8_t) cell->rememberedAppearance.foreColorComponents[1] << 32
+                          | (uint64_t) (uint8_t) cell->rememberedAppearance.foreColorComponents[2] << 24
+                          | (uint8_t) cell->rememberedAppearance.backColorComponents[0] << 16
+                          | (uint8_t) cell->rememberedAppearance.backColorComponents[1] << 8
+                          | (uint8_t) cell->rememberedAppearance.backColorComponents[2]);
+    for (int i = 0; i < 8; i += 4) {
+        hash = mixFingerprint(hash, (uint64_t) (uint16_t) terrainRandomValues[loc.x][loc.y][i] << 48
+                              | (uint64_t) (uint16_t) terrainRandomValues[loc.x][loc.y][i + 1] << 32
+                              | (uint16_t) terrainRandomValues[loc.x][loc.y][i + 2] << 16
+                              | (uint16_t) terrainRandomValues[loc.x][loc.y][i + 3]);
+    }
+    hash = mixFingerprint(hash, (uint64_t) displayDetail[loc.x][loc.y] << 32
+                          | (loc.y + 1 < DROWS ? displayBuffer.cells[mapToWindowX(loc.x)][mapToWindowY(loc.y + 1)].character : 0));
+    if (rogue.displayStealthRangeMode && (cell->flags & IN_FIELD_OF_VIEW)) {
+        // Only whether the cell falls outside the stealth range matters, not the scent turn itself.
+        const short distance = min(rogue.scentTurnNumber - scentMap[loc.x][loc.y],
+                                   scentDistance(loc.x, loc.y, player.loc.x, player.loc.y));
+        hash = mixFingerprint(hash, distance > rogue.stealthRange * 2);
+    }
+    hash = creatureFingerprint(hash, monst);
+    return itemFingerprint(hash, theItem);
+}
+
+// Display state that affects every cell of the map.
+static uint64_t displaySignature() {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+
+    hash = mixFingerprint(hash, (uintptr_t) player.info.foreColor);
+    hash = mixFingerprint(hash, (uint64_t) player.info.displayChar << 32 | (uint16_t) rogue.depthLevel << 16
+                          | (uint16_t) rogue.cursorPathIntensity);
+    hash = mixFingerprint(hash, (rogue.trueColorMode ? 1 : 0)
+                          | (rogue.playbackOmniscience ? 2 : 0)
+                          | (rogue.inWater ? 4 : 0)
+                          | (rogue.displayStealthRangeMode ? 64 : 0)
+                          | (player.status[STATUS_TELEPATHIC] ? 8 : 0)
+                          | (player.status[STATUS_LEVITATING] ? 16 : 0)
+                          | ((terrainFlags(player.loc) & T_IS_DEEP_WATER) ? 32 : 0));
+    return hash;
+}
+
+// Whether the cache can be trusted at all. Hallucination redraws are random by design,
+// and the scent display depends on the turn counter, so those always recompute every cell.
+static boolean appearanceCacheUsable() {
+    return !player.status[STATUS_HALLUCINATING]
+        && !D_SCENT_VISION;
+}
+
+static void cacheCellAppearance(pos loc, enum displayGlyph cellChar, const color *foreColor, const color *backColor) {
+    cachedAppearance[loc.x][loc.y].character = cellChar;
+    cachedAppearance[loc.x][loc.y].foreColor = *foreColor;
+    cachedAppearance[loc.x][loc.y].backColor = *backColor;
+}
+
+// Compares the incremental screen against a full redraw, and reports any cell that differs.
+static void validateDisplayCache() {
+    enum displayGlyph cellChar;
+    color foreColor, backColor;
+    short mismatches = 0;
+
+    for (int i = 0; i < DCOLS; i++) {
+        for (int j = DROWS - 1; j >= 0; j--) {
+            const cellAppearance *cached = &cachedAppearance[i][j];
+            getCellAppearance((pos){ i, j }, &cellChar, &foreColor, &backColor);
+            if (cellChar != cached->character
+                || foreColor.red != cached->foreColor.red
+                || foreColor.green != cached->foreColor.green
+                || foreColor.blue != cached->foreColor.blue
+                || backColor.red != cached->backColor.red
+                || backColor.green != cached->backColor.green
+                || backColor.blue != cached->backColor.blue) {
+
+                printf("\nDepth %i: display cache mismatch at (%i, %i): cached glyph %i, full redraw glyph %i.",
+                       rogue.depthLevel, i, j, cached->character, cellChar);
+                mismatches++;
+            }
+        }
+    }
+    if (mismatches) {
+        printf("\nDepth %i: %i cells of the incremental display differ from a full redraw.", rogue.depthLevel, mismatches);
+        markAllCellsDirty();
+    }
+}
+
 // higher-level redraw
 void displayLevel() {
+    static creature *monsterMap[DCOLS][DROWS];
+    static item *itemMap[DCOLS][DROWS];
+    enum displayGlyph cellChar;
+    color foreColor, backColor;
     short i, j;
 
+    const uint64_t signature = displaySignature();
+    if (signature != cachedDisplaySignature || !appearanceCacheUsable()) {
+        cachedDisplaySignature = signature;
+        markAllCellsDirty();
+    }
+
+    // Look up the occupant of every cell once, rather than walking the lists per cell.
+    // Like monsterAtLoc() and itemAtLoc(), the first entry in each list wins.
+    memset(monsterMap, 0, sizeof(monsterMap));
+    memset(itemMap, 0, sizeof(itemMap));
+    for (creatureIterator it = iterateCreatures(monsters); hasNextCreature(it);) {
+        creature *monst = nextCreature(&it);
+        if (isPosInMap(monst->loc) && !monsterMap[monst->loc.x][monst->loc.y]) {
+            monsterMap[monst->loc.x][monst->loc.y] = monst;
+        }
+    }
+    for (creatureIterator it = iterateCreatures(dormantMonsters); hasNextCreature(it);) {
+        creature *monst = nextCreature(&it);
+        if (isPosInMap(monst->loc) && !monsterMap[monst->loc.x][monst->loc.y]
+            && !(pmapAt(monst->loc)->flags & HAS_MONSTER)) {
+            monsterMap[monst->loc.x][monst->loc.y] = monst;
+        }
+    }
+    for (item *theItem = floorItems->nextItem; theItem != NULL; theItem = theItem->nextItem) {
+        if (isPosInMap(theItem->loc) && !itemMap[theItem->loc.x][theItem->loc.y]) {
+            itemMap[theItem->loc.x][theItem->loc.y] = theItem;
+        }
+    }
+
     for( i=0; i<DCOLS; i++ ) {
         for (j = DROWS-1; j >= 0; j--) {
-            refreshDungeonCell((pos){ i, j });
+            const pos loc = { i, j };
+            const unsigned long flags = pmapAt(loc)->flags;
+            const creature *monst = (flags & (HAS_MONSTER | HAS_DORMANT_MONSTER)) ? monsterMap[i][j] : NULL;
+            const item *theItem = (flags & HAS_ITEM) ? itemMap[i][j] : NULL;
+
+            if (!cellIsDirty(loc)
+                && (!(flags & (HAS_MONSTER | HAS_DORMANT_MONSTER)) || monst)
+                && (!(flags & HAS_ITEM) || theItem)
+                && cellFingerprint(loc, monst, theItem) == cachedFingerprint[i][j]) {
+
+                const cellAppearance *cached = &cachedAppearance[i][j];
+                plotCharWithColor(cached->character, mapToWindow(loc), &cached->foreColor, &cached->backColor);
+            } else {
+                getCellAppearance(loc, &cellChar, &foreColor, &backColor);
+                plotCharWithColor(cellChar, mapToWindow(loc), &foreColor, &backColor);
+                cacheCellAppearance(loc, cellChar, &foreColor, &backColor);
+                // getCellAppearance() may have updated the cell's memory, so fingerprint it afterwards.
+                cachedFingerprint[i][j] = cellFingerprint(loc, monst, theItem);
+                markCellClean(loc);
+            }
         }
     }
+
+    if (D_VALIDATE_DISPLAY_CACHE && appearanceCacheUsable()) {
+        validateDisplayCache();
+    }
 }
 
 // converts colors into components
@@ -1508,6 +1745,9 @@ void refreshDungeonCell(pos loc) {
 
     getCellAppearance(loc, &cellChar, &foreColor, &backColor);
     plotCharWithColor(cellChar, mapToWindow(loc), &foreColor, &backColor);
+
+    // The cell changed outside of displayLevel(), so its cached appearance is stale.
+    markCellDirty(loc);
 }
 
 void applyColorMultiplier(color *baseColor, const color *multiplierColor) {
@@ -1725,7 +1965,7 @@ void hiliteCell(short x, short y, const color *hiliteColor, short hiliteStrength
     restoreRNG;
 }
 
-static short adjustedLightValue(short x) {
+static short computeAdjustedLightValue(short x) {
     if (x <= LIGHT_SMOOTHING_THRESHOLD) {
         return x;
     } else {
@@ -1733,6 +1973,25 @@ static short adjustedLightValue(short x) {
     }
 }
 
+// Light values below this are looked up instead of running fp_sqrt() for every channel of every cell.
+#define LIGHT_VALUE_TABLE_SIZE  1024
+
+static short adjustedLightValue(short x) {
+    static short lightValueTable[LIGHT_VALUE_TABLE_SIZE];
+    static boolean lightValueTableReady = false;
+
+    if (x < 0 || x >= LIGHT_VALUE_TABLE_SIZE) {
+        return computeAdjustedLightValue(x);
+    }
+    if (!lightValueTableReady) {
+        for (short i = 0; i < LIGHT_VALUE_TABLE_SIZE; i++) {
+            lightValueTable[i] = computeAdjustedLightValue(i);
+        }
+        lightValueTableReady = true;
+    }
+    return lightValueTable[x];
+}
+
 void colorMultiplierFromDungeonLight(short x, short y, color *editColor) {
 
     editColor->red      = editColor->redRand    = adjustedLightValue(max(0, tmap[x][y].light[0]));
@@ -1966,32 +2225,107 @@ void restoreDisplayBuffer(const SavedDisplayBuffer *savedBuf) {
     displayBuffer = savedBuf->savedScreen;
 }
 
+// Baked colors (no random components) for one column of the screen, one array per channel,
+// so that the blending kernels below run over contiguous shorts and vectorise.
+typedef struct colorColumn {
+    short red[ROWS];
+    short green[ROWS];
+    short blue[ROWS];
+} colorColumn;
+
+static void loadColorColumn(colorColumn *column, const cellDisplayBuffer cells[ROWS], boolean foreground) {
+    for (short j = 0; j < ROWS; j++) {
+        const char *components = (foreground ? cells[j].foreColorComponents : cells[j].backColorComponents);
+        column->red[j] = components[0];
+        column->green[j] = components[1];
+        column->blue[j] = components[2];
+    }
+}
+
+// applyColorAverage() for a whole channel, with a separate weight for each element.
+static void averageChannel(short channel[ROWS], const short newChannel[ROWS], const short weight[ROWS]) {
+    for (short j = 0; j < ROWS; j++) {
+        channel[j] = (channel[j] * (100 - weight[j]) + newChannel[j] * weight[j]) / 100;
+    }
+}
+
+static void averageColorColumn(colorColumn *column, const colorColumn *newColumn, const short weight[ROWS]) {
+    averageChannel(column->red, newColumn->red, weight);
+    averageChannel(column->green, newColumn->green, weight);
+    averageChannel(column->blue, newColumn->blue, weight);
+}
+
+// plotCharWithColor() for the cells of column x that are selected by the mask. Since the colors
+// are baked, no random numbers are drawn, exactly as plotCharWithColor() would draw none.
+static void plotColorColumn(short x, const enum displayGlyph characters[ROWS],
+                            const colorColumn *foreColors, const colorColumn *backColors, const short mask[ROWS]) {
+    if (rogue.gameHasEnded || rogue.playbackFastForward) {
+        return;
+    }
+    for (short j = 0; j < ROWS; j++) {
+        if (!mask[j]) {
+            continue;
+        }
+        const short foreRed = clamp(foreColors->red[j], 0, 100),
+            foreGreen = clamp(foreColors->green[j], 0, 100),
+            foreBlue = clamp(foreColors->blue[j], 0, 100),
+            backRed = clamp(backColors->red[j], 0, 100),
+            backGreen = clamp(backColors->green[j], 0, 100),
+            backBlue = clamp(backColors->blue[j], 0, 100);
+
+        cellDisplayBuffer *target = &displayBuffer.cells[x][j];
+        if (foreRed == backRed && foreGreen == backGreen && foreBlue == backBlue) {
+            target->character = ' ';
+        } else {
+            target->character = characters[j];
+        }
+        target->foreColorComponents[0] = foreRed;
+        target->foreColorComponents[1] = foreGreen;
+        target->foreColorComponents[2] = foreBlue;
+        target->backColorComponents[0] = backRed;
+        target->backColorComponents[1] = backGreen;
+        target->backColorComponents[2] = backBlue;
+    }
+}
+
 // draws overBuf over the current display with per-cell pseudotransparency as specified in overBuf.
 void overlayDisplayBuffer(const screenDisplayBuffer *overBuf) {
+    colorColumn foreColors, backColors, screenBackColors;
+    enum displayGlyph characters[ROWS];
+    short opacity[ROWS], transparency[ROWS], foreWeight[ROWS];
+
     for (int i=0; i<COLS; i++) {
-        for (int j=0; j<ROWS; j++) {
-            if (overBuf->cells[i][j].opacity != 0) {
-                color foreColor, backColor, tempColor;
-                enum displayGlyph character;
-                backColor = colorFromComponents(overBuf->cells[i][j].backColorComponents);
-
-                // character and fore color:
-                if (overBuf->cells[i][j].character == ' ') { // Blank cells in the overbuf take the character from the screen.
-                    character = displayBuffer.cells[i][j].character;
-                    foreColor = colorFromComponents(displayBuffer.cells[i][j].foreColorComponents);
-                    applyColorAverage(&foreColor, &backColor, overBuf->cells[i][j].opacity);
-                } else {
-                    character = overBuf->cells[i][j].character;
-                    foreColor = colorFromComponents(overBuf->cells[i][j].foreColorComponents);
-                }
+        const cellDisplayBuffer *over = overBuf->cells[i];
+        const cellDisplayBuffer *screen = displayBuffer.cells[i];
+        boolean anyOpaque = false;
 
-                // back color:
-                tempColor = colorFromComponents(displayBuffer.cells[i][j].backColorComponents);
-                applyColorAverage(&backColor, &tempColor, 100 - overBuf->cells[i][j].opacity);
+        for (int j=0; j<ROWS; j++) {
+            opacity[j] = over[j].opacity;
+            transparency[j] = 100 - opacity[j];
+            anyOpaque |= (opacity[j] != 0);
+        }
+        if (!anyOpaque) {
+            continue;
+        }
 
-                plotCharWithColor(character, (windowpos){ i, j }, &foreColor, &backColor);
-            }
+        // character and fore color:
+        loadColorColumn(&backColors, over, false);
+        for (int j=0; j<ROWS; j++) {
+            const cellDisplayBuffer *source = (over[j].character == ' ' ? &screen[j] : &over[j]);
+            // Blank cells in the overbuf take the character from the screen, faded towards the overbuf's back color.
+            characters[j] = source->character;
+            foreColors.red[j] = source->foreColorComponents[0];
+            foreColors.green[j] = source->foreColorComponents[1];
+            foreColors.blue[j] = source->foreColorComponents[2];
+            foreWeight[j] = (over[j].character == ' ' ? opacity[j] : 0);
         }
+        averageColorColumn(&foreColors, &backColors, foreWeight);
+
+        // back color:
+        loadColorColumn(&screenBackColors, screen, false);
+        averageColorColumn(&backColors, &screenBackColors, transparency);
+
+        plotColorColumn(i, characters, &foreColors, &backColors, opacity);
     }
 }
 
@@ -2365,7 +2699,9 @@ static void exploreKey(const boolean controlKey) {
 }
 
 boolean pauseBrogue(short milliseconds, PauseBehavior behavior) {
-    commitDraws();
+    if (!behavior.skipScreenUpdate) {
+        commitDraws();
+    }
     if (rogue.playbackMode && rogue.playbackFastForward) {
         return true;
     }
@@ -2592,6 +2928,16 @@ void executeKeystroke(signed long keystroke, boolean controlKey, boolean shiftKe
                                  &teal, 0);
             }
             break;
+        case INSTANT_TRAVEL_KEY:
+            rogue.instantTravel = !rogue.instantTravel;
+            if (rogue.instantTravel) {
+                messageWithColor(KEYBOARD_LABELS ? "Instant travel enabled. Press '[' again to animate." : "Instant travel enabled.",
+                                 &teal, 0);
+            } else {
+                messageWithColor(KEYBOARD_LABELS ? "Instant travel disabled. Press '[' again to enable." : "Instant travel disabled.",
+                                 &teal, 0);
+            }
+            break;
         case CALL_KEY:
             call(NULL);
             break;
@@ -3011,9 +3357,46 @@ static void dequeueEvent() {
     nextBrogueEvent(&returnEvent, false, false, true);
 }
 
+// Formatted lines of the message archive, oldest first, kept in step with the archive so that
+// neither the recent messages nor the archive view re-fold and re-wrap every message each time.
+// Each fold group (a single message, or a run of FOLDABLE messages from the same turn) is
+// formatted once. message() can only change the latest entry and entries from the current
+// turn, so it just marks where the archive changed and the groups from there on are redone.
+// Archive entries are identified by sequence numbers that count up from the last clear.
+
+typedef struct formattedMessageGroup {
+    unsigned long newestEntry;  // sequence number of the newest archive entry in the group
+    short entries;              // how many archive entries were folded together
+    short lines;                // how many lines the group formats to (some may have been dropped)
+    unsigned long turn;         // player turn shared by the folded messages
+} formattedMessageGroup;
+
+static struct {
+    char lines[MESSAGE_ARCHIVE_LINES][COLS*2];              // ring of formatted lines
+    short firstLine, lineCount;
+    formattedMessageGroup groups[MESSAGE_ARCHIVE_LINES];    // ring; every group has at least one line kept
+    short firstGroup, groupCount;
+    long groupLines;                                        // total lines of all the groups
+    unsigned long entryCount;                               // sequence number for the next archive entry
+    unsigned long dirtyFrom;                                // oldest entry that changed since the last update
+} formattedMessages;
+
+static void resetFormattedMessages() {
+    formattedMessages.firstLine = formattedMessages.lineCount = 0;
+    formattedMessages.firstGroup = formattedMessages.groupCount = 0;
+    formattedMessages.groupLines = 0;
+    formattedMessages.entryCount = 0;
+    formattedMessages.dirtyFrom = 1;
+}
+
+static void markFormattedMessagesDirty(unsigned long entry) {
+    formattedMessages.dirtyFrom = min(formattedMessages.dirtyFrom, entry);
+}
+
 // Empty the message archive
 void clearMessageArchive() {
     messageArchivePosition = 0;
+    resetFormattedMessages();
 }
 
 // Get a pointer to the archivedMessage the given number of entries back in history.
@@ -3157,6 +3540,145 @@ static void splitLines(short lines, char wrapped[COLS*20], char buffer[][COLS*2]
     strncpy(buffer[bufferCursor], line, COLS*2);
 }
 
+static formattedMessageGroup *formattedGroup(short index) {
+    return &formattedMessages.groups[(formattedMessages.firstGroup + index) % MESSAGE_ARCHIVE_LINES];
+}
+
+static char *formattedLine(short index) {
+    return formattedMessages.lines[(formattedMessages.firstLine + index) % MESSAGE_ARCHIVE_LINES];
+}
+
+// Folds, punctuates and wraps the group whose newest entry is the given number of entries back
+// in the archive (zero being the newest), exactly as formatRecentMessages() displays it.
+// The newest lines end at the bottom of lineBuffer; returns the number of lines it formats to.
+static short formatMessageGroup(short offset, formattedMessageGroup *group, char lineBuffer[MESSAGE_ARCHIVE_LINES][COLS*2]) {
+    static char folded[COLS*20], wrapped[COLS*20];
+    short lines;
+
+    group->entries = foldMessages(folded, offset, &group->turn);
+    group->newestEntry = formattedMessages.entryCount - 1 - offset;
+    capitalizeAndPunctuateSentences(folded, COLS*20);
+    lines = wrapText(wrapped, folded, DCOLS);
+    splitLines(lines, wrapped, lineBuffer, MESSAGE_ARCHIVE_LINES - 1);
+    group->lines = lines;
+    return lines;
+}
+
+static void dropOldestFormattedGroup() {
+    formattedMessageGroup *oldest = formattedGroup(0);
+    const long linesKept = formattedMessages.lineCount - (formattedMessages.groupLines - oldest->lines);
+
+    formattedMessages.firstLine = (formattedMessages.firstLine + linesKept) % MESSAGE_ARCHIVE_LINES;
+    formattedMessages.lineCount -= linesKept;
+    formattedMessages.groupLines -= oldest->lines;
+    formattedMessages.firstGroup = (formattedMessages.firstGroup + 1) % MESSAGE_ARCHIVE_LINES;
+    formattedMessages.groupCount--;
+}
+
+static void appendFormattedGroup(short offset) {
+    static char lineBuffer[MESSAGE_ARCHIVE_LINES][COLS*2];
+    formattedMessageGroup group;
+    short lines, pushed, i;
+
+    lines = formatMessageGroup(offset, &group, lineBuffer);
+    pushed = 0;
+    for (i = max(0, MESSAGE_ARCHIVE_LINES - lines); i < MESSAGE_ARCHIVE_LINES; i++) {
+        if (formattedMessages.lineCount == MESSAGE_ARCHIVE_LINES) {
+            formattedMessages.firstLine = (formattedMessages.firstLine + 1) % MESSAGE_ARCHIVE_LINES;
+            formattedMessages.lineCount--;
+        }
+        strcpy(formattedLine(formattedMessages.lineCount++), lineBuffer[i]);
+        pushed++;
+    }
+
+    // Let go of the groups that have no lines left.
+    while (formattedMessages.groupCount
+           && formattedMessages.lineCount - pushed <= formattedMessages.groupLines - formattedGroup(0)->lines) {
+
+        formattedMessages.groupLines -= formattedGroup(0)->lines;
+        formattedMessages.firstGroup = (formattedMessages.firstGroup + 1) % MESSAGE_ARCHIVE_LINES;
+        formattedMessages.groupCount--;
+    }
+    *formattedGroup(formattedMessages.groupCount++) = group;
+    formattedMessages.groupLines += lines;
+}
+
+// Returns false if there was no room for all of its lines.
+static boolean prependFormattedGroup(short offset) {
+    static char lineBuffer[MESSAGE_ARCHIVE_LINES][COLS*2];
+    formattedMessageGroup group;
+    short lines, i;
+
+    lines = formatMessageGroup(offset, &group, lineBuffer);
+    for (i = MESSAGE_ARCHIVE_LINES - 1;
+         i >= MESSAGE_ARCHIVE_LINES - lines && i >= 0 && formattedMessages.lineCount < MESSAGE_ARCHIVE_LINES;
+         i--) {
+
+        formattedMessages.firstLine = (formattedMessages.firstLine + MESSAGE_ARCHIVE_LINES - 1) % MESSAGE_ARCHIVE_LINES;
+        formattedMessages.lineCount++;
+        strcpy(formattedLine(0), lineBuffer[i]);
+    }
+    formattedMessages.firstGroup = (formattedMessages.firstGroup + MESSAGE_ARCHIVE_LINES - 1) % MESSAGE_ARCHIVE_LINES;
+    formattedMessages.groupCount++;
+    *formattedGroup(0) = group;
+    formattedMessages.groupLines += lines;
+    return (i < MESSAGE_ARCHIVE_LINES - lines);
+}
+
+// Brings the formatted lines up to date with the archive, with at least height lines if there
+// are enough messages.
+static void updateFormattedMessages(short height) {
+    const unsigned long entryCount = formattedMessages.entryCount;
+    unsigned long entry;
+    archivedMessage *m, *next;
+
+    // Drop the groups that changed, and the one before in case a change lets it fold further.
+    while (formattedMessages.groupCount
+           && formattedGroup(formattedMessages.groupCount - 1)->newestEntry + 1 >= formattedMessages.dirtyFrom) {
+
+        formattedMessageGroup *newest = formattedGroup(formattedMessages.groupCount - 1);
+        formattedMessages.lineCount = max(0, formattedMessages.lineCount - newest->lines);
+        formattedMessages.groupLines -= newest->lines;
+        formattedMessages.groupCount--;
+    }
+    if (formattedMessages.groupCount && formattedMessages.groupLines > formattedMessages.lineCount
+        && formattedMessages.lineCount < height) {
+        // The oldest group lost some of its lines, and they are needed again.
+        dropOldestFormattedGroup();
+    }
+    formattedMessages.dirtyFrom = entryCount + 1;
+
+    // Append the new messages, oldest first. A run of FOLDABLE messages from one turn folds into
+    // a single group, which ends at its newest message; any other message is a group of its own.
+    if (formattedMessages.groupCount) {
+        for (entry = formattedGroup(formattedMessages.groupCount - 1)->newestEntry + 1; entry < entryCount; entry++) {
+            if (entry + 1 < entryCount) {
+                m = getArchivedMessage(entryCount - entry);
+                next = getArchivedMessage(entryCount - entry - 1);
+                if ((m->flags & FOLDABLE) && (next->flags & FOLDABLE) && m->turn == next->turn) {
+                    continue;
+                }
+            }
+            appendFormattedGroup(entryCount - 1 - entry);
+        }
+    }
+
+    // Then fill in older messages, newest first, until there are enough lines.
+    while (formattedMessages.lineCount < height) {
+        entry = (formattedMessages.groupCount
+                 ? formattedGroup(0)->newestEntry - formattedGroup(0)->entries + 1
+                 : entryCount);
+        if (entry == 0
+            || entryCount - entry >= MESSAGE_ARCHIVE_ENTRIES
+            || !getArchivedMessage(entryCount - entry + 1)->message[0]) {
+            break;
+        }
+        if (!prependFormattedGroup(entryCount - entry)) {
+            break;
+        }
+    }
+}
+
 // Fill the buffer of height lines with archived messages.  Fill from the
 // bottom, so that the most recent message appears in the last line of buffer.
 // linesFormatted, if not null, is filled with the number of formatted lines
@@ -3164,37 +3686,35 @@ static void splitLines(short lines, char wrapped[COLS*20], char buffer[][COLS*2]
 // latestMessageLines, if not null, is filled with the number of formatted
 // lines generated by events from the current player turn.
 void formatRecentMessages(char buffer[][COLS*2], size_t height, short *linesFormatted, short *latestMessageLines) {
-    short lines, bufferCursor, messagesFolded, messagesFormatted;
-    unsigned long turn;
-    char folded[COLS*20], wrapped[COLS*20];
+    short lines, bufferCursor, i;
+    formattedMessageGroup *group;
 
-    bufferCursor = height - 1;
-    messagesFormatted = 0;
+    updateFormattedMessages(height);
 
     if (latestMessageLines) {
         *latestMessageLines = 0;
     }
 
-    while (bufferCursor >= 0 && messagesFormatted < MESSAGE_ARCHIVE_ENTRIES) {
-        messagesFolded = foldMessages(folded, messagesFormatted, &turn);
-        if (messagesFolded == 0) {
+    // Take the newest groups until they fill the buffer.
+    lines = 0;
+    for (i = formattedMessages.groupCount - 1; i >= 0 && lines < (short) height; i--) {
+        group = formattedGroup(i);
+        if (formattedMessages.entryCount - 1 - group->newestEntry >= MESSAGE_ARCHIVE_ENTRIES) {
             break;
         }
-
-        capitalizeAndPunctuateSentences(folded, COLS*20);
-        lines = wrapText(wrapped, folded, DCOLS);
-        splitLines(lines, wrapped, buffer, bufferCursor);
-
-        if (latestMessageLines && turn == rogue.playerTurnNumber) {
-            *latestMessageLines += lines;
+        if (latestMessageLines && group->turn == rogue.playerTurnNumber) {
+            *latestMessageLines += group->lines;
         }
-
-        bufferCursor -= lines;
-        messagesFormatted += messagesFolded;
+        lines += group->lines;
     }
 
     if (linesFormatted) {
-        *linesFormatted = height - 1 - bufferCursor;
+        *linesFormatted = lines;
+    }
+
+    bufferCursor = height - 1;
+    for (i = formattedMessages.lineCount - 1; i >= 0 && bufferCursor >= 0 && bufferCursor >= (short) height - lines; i--) {
+        strcpy(buffer[bufferCursor--], formattedLine(i));
     }
 
     while (bufferCursor >= 0) {
@@ -3479,6 +3999,7 @@ void message(const char *msg, unsigned long flags) {
             // as having happened on the current turn, and bump its count if
             // not maxxed out.
             newMessage = false;
+            markFormattedMessagesDirty(formattedMessages.entryCount - i);
             archiveEntry->turn = rogue.playerTurnNumber;
             if (archiveEntry->count < MAX_MESSAGE_REPEATS) {
                 archiveEntry->count++;
@@ -3496,6 +4017,7 @@ void message(const char *msg, unsigned long flags) {
         archiveEntry->turn = rogue.playerTurnNumber;
         archiveEntry->flags = flags;
         messageArchivePosition = (messageArchivePosition + 1) % MESSAGE_ARCHIVE_ENTRIES;
+        markFormattedMessagesDirty(formattedMessages.entryCount++);
     }
 
     displayRecentMessages();
@@ -3682,6 +4204,181 @@ enum entityDisplayTypes {
     EDT_TERRAIN,
 };
 
+// Sidebar entry cache. The sidebar is redrawn after nearly every turn, but most entries
+// look exactly the same as they did on the previous turn. Each entry is fingerprinted
+// with the game state its print function reads, without doing the printing work itself:
+// the map cell's fingerprint and the display signature (see displayLevel()) stand in for
+// the cell appearance, and the entity's own fields stand in for its name, health and
+// status effects. The row it starts on and whether it is dimmed or highlighted are
+// included too, and the cells it drew are kept per starting row. When an entry with the
+// same fingerprint starts on the same row again, its cells are copied back into the
+// display buffer instead of being printed. Entries shown while hallucinating are always
+// printed, since their names and glyphs are randomized.
+
+typedef struct sidebarEntry {
+    uint64_t fingerprint;
+    short endY; // 0 if the slot is empty
+    cellDisplayBuffer cells[STAT_BAR_WIDTH][ROWS];
+} sidebarEntry;
+
+static sidebarEntry sidebarCache[ROWS];
+
+static boolean colorIsStable(const color *theColor) {
+    return !(theColor->rand || theColor->redRand || theColor->greenRand || theColor->blueRand);
+}
+
+static uint64_t stringFingerprint(uint64_t hash, const char *theString) {
+    short i;
+
+    for (i = 0; theString[i] != '\0'; i++) {
+        hash = mixFingerprint(hash, (unsigned char) theString[i]);
+    }
+    return mixFingerprint(hash, i);
+}
+
+// Folds what getCellAppearance() reads for the cell that the print functions plot at the start
+// of the entry into the fingerprint. getCellAppearance() bakes its colors, so the result has
+// no random components to worry about.
+static uint64_t sidebarCellFingerprint(uint64_t hash, pos loc) {
+    const unsigned long flags = pmapAt(loc)->flags;
+    const creature *monst = NULL;
+    const item *theItem = (flags & HAS_ITEM) ? itemAtLoc(loc) : NULL;
+
+    if (flags & (HAS_MONSTER | HAS_PLAYER)) {
+        monst = monsterAtLoc(loc);
+    } else if (flags & HAS_DORMANT_MONSTER) {
+        monst = dormantMonsterAtLoc(loc);
+    }
+
+    // The print functions plot the cell as it looks off the cursor path.
+    pmapAt(loc)->flags &= ~IS_IN_PATH;
+    hash = mixFingerprint(hash, cellFingerprint(loc, monst, theItem));
+    if (flags & IS_IN_PATH) {
+        pmapAt(loc)->flags |= IS_IN_PATH;
+    }
+    return mixFingerprint(hash, displaySignature());
+}
+
+static boolean sidebarCreatureFingerprint(uint64_t *hash, creature *monst) {
+    short i, armorValue;
+
+    if (monst->mutationIndex >= 0) {
+        if (!colorIsStable(mutationCatalog[monst->mutationIndex].textColor)) {
+            return false;
+        }
+    }
+    *hash = sidebarCellFingerprint(*hash, monst->loc);
+    *hash = creatureFingerprint(*hash, monst);
+    *hash = mixFingerprint(*hash, (uint64_t) monst->info.monsterID << 48 | (uint64_t) (uint16_t) monst->mutationIndex << 32
+                           | (uint16_t) monst->currentHP << 16 | (uint16_t) monst->info.maxHP);
+    *hash = mixFingerprint(*hash, (uint64_t) (uint16_t) monst->previousHealthPoints << 32
+                           | (uint16_t) monst->weaknessAmount << 16 | (uint16_t) monst->poisonAmount);
+    for (i = 0; i < NUMBER_OF_STATUS_EFFECTS; i++) {
+        *hash = mixFingerprint(*hash, (uint64_t) (uint32_t) monst->status[i] << 32 | (uint32_t) monst->maxStatus[i]);
+    }
+    *hash = mixFingerprint(*hash, posEq(monst->targetCorpseLoc, monst->loc) ? monst->corpseAbsorptionCounter + 1 : 0);
+
+    if (monst == &player) {
+        if (!rogue.armor || rogue.armor->flags & ITEM_IDENTIFIED || rogue.playbackOmniscience) {
+            armorValue = displayedArmorValue();
+        } else {
+            armorValue = -1 - max(0, armorValueIfUnenchanted(rogue.armor) - player.status[STATUS_DONNING]);
+        }
+        *hash = mixFingerprint(*hash, (uint64_t) (uint16_t) rogue.strength << 48 | (uint64_t) (uint16_t) armorValue << 32
+                               | (uint16_t) rogue.stealthRange << 16
+                               | (playerInDarkness() ? 2 : 0)
+                               | ((pmapAt(player.loc)->flags & IS_IN_SHADOW) ? 1 : 0));
+        *hash = mixFingerprint(*hash, rogue.gold);
+    } else {
+        // The name is the monster's own unless the player can't see it.
+        *hash = mixFingerprint(*hash, (uint64_t) monst->creatureState << 8
+                               | (canSeeMonster(monst) ? 64 : 0)
+                               | (monst->wasNegated && monst->newPowerCount == monst->totalPowerCount ? 32 : 0)
+                               | (monst->leader && (monst->leader->info.flags & MONST_IMMOBILE) ? 16 : 0)
+                               | (monst->leader && (monst->leader->bookkeepingFlags & MB_CAPTIVE) ? 8 : 0)
+                               | (cellHasTMFlag(monst->loc, TM_ALLOWS_SUBMERGING) ? 4 : 0)
+                               | (monst->ticksUntilTurn > max(0, player.ticksUntilTurn) + player.movementSpeed ? 2 : 0));
+    }
+    return true;
+}
+
+static boolean sidebarItemFingerprint(uint64_t *hash, item *theItem) {
+    const itemTable *table = tableForItemCategory(theItem->category);
+
+    // The item's own glyph replaces the player's when it lies underfoot.
+    if (posEq(theItem->loc, player.loc) && !colorIsStable(theItem->foreColor)) {
+        return false;
+    }
+    *hash = sidebarCellFingerprint(*hash, theItem->loc);
+
+    // Everything itemName() reads, beyond what itemFingerprint() covers.
+    *hash = itemFingerprint(*hash, theItem);
+    *hash = mixFingerprint(*hash, (uint64_t) (uint16_t) theItem->enchant2 << 48 | (uint64_t) (uint16_t) theItem->armor << 32
+                           | (uint16_t) theItem->strengthRequired << 16 | (uint16_t) rogue.depthLevel);
+    *hash = stringFingerprint(*hash, theItem->inscription);
+    if (table) {
+        *hash = mixFingerprint(*hash, (table[theItem->kind].identified ? 2 : 0) | (table[theItem->kind].called ? 1 : 0));
+        if (table[theItem->kind].called) {
+            *hash = stringFingerprint(*hash, table[theItem->kind].callTitle);
+        }
+    }
+    return true;
+}
+
+// Prints one sidebar entry starting at row y, or copies it from the cache if it hasn't changed
+// since it was last printed there. Returns the row after the entry, like the print functions.
+static short printSidebarEntry(enum entityDisplayTypes type, const void *entity, pos loc, short y,
+                               boolean dim, boolean highlight) {
+    sidebarEntry *entry = &sidebarCache[y];
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    boolean cacheable;
+    short i, j, endY;
+
+    hash = mixFingerprint(hash, (uint64_t) type << 32 | (uint64_t) (uint16_t) y << 16
+                          | (rogue.playbackOmniscience ? 4 : 0) | (dim ? 2 : 0) | (highlight ? 1 : 0));
+    if (player.status[STATUS_HALLUCINATING]) {
+        cacheable = false; // names, glyphs and descriptions are randomized
+    } else if (type == EDT_CREATURE) {
+        cacheable = sidebarCreatureFingerprint(&hash, (creature *) entity);
+    } else if (type == EDT_ITEM) {
+        cacheable = sidebarItemFingerprint(&hash, (item *) entity);
+    } else {
+        hash = sidebarCellFingerprint(hash, loc);
+        hash = stringFingerprint(hash, (const char *) entity);
+        cacheable = true;
+    }
+
+    if (cacheable && entry->endY && entry->fingerprint == hash) {
+        for (i = 0; i < STAT_BAR_WIDTH; i++) {
+            for (j = y; j < min(entry->endY, ROWS - 1); j++) {
+                displayBuffer.cells[i][j] = entry->cells[i][j];
+            }
+        }
+        return entry->endY;
+    }
+
+    if (type == EDT_CREATURE) {
+        endY = printMonsterInfo((creature *) entity, y, dim, highlight);
+    } else if (type == EDT_ITEM) {
+        endY = printItemInfo((item *) entity, y, dim, highlight);
+    } else {
+        endY = printTerrainInfo(loc.x, loc.y, y, (const char *) entity, dim, highlight);
+    }
+
+    if (cacheable) {
+        entry->fingerprint = hash;
+        entry->endY = endY;
+        for (i = 0; i < STAT_BAR_WIDTH; i++) {
+            for (j = y; j < min(endY, ROWS - 1); j++) {
+                entry->cells[i][j] = displayBuffer.cells[i][j];
+            }
+        }
+    } else {
+        entry->endY = 0;
+    }
+    return endY;
+}
+
 // Refreshes the sidebar.
 // Progresses from the closest visible monster to the farthest.
 // If a monster, item or terrain is focused, then display the sidebar with that monster/item highlighted,
@@ -3867,26 +4564,20 @@ void refreshSideBar(short focusX, short focusY, boolean focusedEntityMustGoFirst
         if (entityType[i] == EDT_CREATURE) {
             x = ((creature *) entityList[i])->loc.x;
             y = ((creature *) entityList[i])->loc.y;
-            printY = printMonsterInfo((creature *) entityList[i],
-                                      printY,
-                                      (focusEntity && (x != focusX || y != focusY)),
-                                      (x == focusX && y == focusY));
-
         } else if (entityType[i] == EDT_ITEM) {
             x = ((item *) entityList[i])->loc.x;
             y = ((item *) entityList[i])->loc.y;
-            printY = printItemInfo((item *) entityList[i],
-                                   printY,
-                                   (focusEntity && (x != focusX || y != focusY)),
-                                   (x == focusX && y == focusY));
         } else if (entityType[i] == EDT_TERRAIN) {
             x = terrainLocationMap[i].x;
             y = terrainLocationMap[i].y;
-            printY = printTerrainInfo(x, y,
-                                      printY,
-                                      ((const char *) entityList[i]),
-                                      (focusEntity && (x != focusX || y != focusY)),
-                                      (x == focusX && y == focusY));
+        }
+        if (entityType[i] != EDT_NOTHING) {
+            printY = printSidebarEntry(entityType[i],
+                                       entityList[i],
+                                       (pos){ x, y },
+                                       printY,
+                                       (focusEntity && (x != focusX || y != focusY)),
+                                       (x == focusX && y == focusY));
         }
         if (focusEntity && (x == focusX && y == focusY) && printY < ROWS) {
             gotFocusedEntityOnScreen = true;
@@ -4061,7 +4752,7 @@ char nextKeyPress(boolean textInput) {
     return theEvent.param1;
 }
 
-#define BROGUE_HELP_LINE_COUNT  33
+#define BROGUE_HELP_LINE_COUNT  34
 
 void printHelpScreen() {
     short i, j;
@@ -4096,6 +4787,7 @@ void printHelpScreen() {
         "",
         "              \\  ****disable/enable color effects",
         "              ]  ****display/hide stealth range",
+        "              [  ****instant/animated explore and travel",
         "    <space/esc>  ****clear message or cancel command",
         "",
         "        -- press space or click to continue --"
@@ -888,6 +888,7 @@ void pickUpItemAt(pos loc) {
         }
 
         theItem = addItemToPack(theItem);
+        rogue.itemsFound++;
 
         itemName(theItem, buf2, true, true, NULL); // include suffix, article
 
@@ -3404,6 +3405,65 @@ void aggravateMonsters(short distance, short x, short y, const color *flashColor
     freeGrid(grid);
 }
 
+// Set of candidate waypoints strategically placed within a diamond shape.
+// For why they must be within a diamond, google "diamond-exit rule".
+#define LINE_OFFSET_COUNT   21
+static const fixpt lineOffsets[LINE_OFFSET_COUNT][2] = {
+    {50, 50}, // center of the square first (coordinates are in %)
+    {40, 40}, {60, 40}, {60, 60}, {40, 60},
+    {50, 30}, {70, 50}, {50, 70}, {30, 50},
+    {50, 20}, {80, 50}, {50, 80}, {20, 50},
+    {50, 10}, {90, 50}, {50, 90}, {10, 50},
+    {50,  1}, {99, 50}, {50, 99}, { 1, 50} };
+
+// The step of each candidate line, normalized to move exactly one row or column at a time, for
+// every offset from origin to target within the map. It depends on nothing else, so it is worked
+// out once, the first time a line is traced; bolts, autotargeting and the targeting cursor then
+// need no divisions. A normalized step is at most FP_FACTOR in magnitude, so the steps are stored
+// as int rather than fixpt, which halves the table to about 1.5 MB.
+static int lineSteps[2 * DCOLS - 1][2 * DROWS - 1][LINE_OFFSET_COUNT][2];
+static boolean lineStepsReady = false;
+
+static void computeLineStep(fixpt step[2], const short dx, const short dy, const short offset) {
+    // always shoot from the center of the origin cell; vector to target
+    step[0] = dx * FP_FACTOR + lineOffsets[offset][0] * FP_FACTOR / 100 - FP_FACTOR/2;
+    step[1] = dy * FP_FACTOR + lineOffsets[offset][1] * FP_FACTOR / 100 - FP_FACTOR/2;
+
+    // normalize the step, to move exactly one row or column at a time
+    fixpt m = max(llabs(step[0]), llabs(step[1]));
+    step[0] = step[0] * FP_FACTOR / m;
+    step[1] = step[1] * FP_FACTOR / m;
+}
+
+static void getLineStep(fixpt step[2], const pos originLoc, const pos targetLoc, const short offset) {
+    const short dx = targetLoc.x - originLoc.x;
+    const short dy = targetLoc.y - originLoc.y;
+    short i, j, k;
+
+    if (abs(dx) >= DCOLS || abs(dy) >= DROWS) {
+        computeLineStep(step, dx, dy, offset);
+        return;
+    }
+    if (!lineStepsReady) {
+        for (i = 0; i < 2 * DCOLS - 1; i++) {
+            for (j = 0; j < 2 * DROWS - 1; j++) {
+                for (k = 0; k < LINE_OFFSET_COUNT; k++) {
+                    if (i == DCOLS - 1 && j == DROWS - 1) {
+                        continue; // no line from a cell to itself
+                    }
+                    computeLineStep(step, i - (DCOLS - 1), j - (DROWS - 1), k);
+                    brogueAssert(llabs(step[0]) <= FP_FACTOR && llabs(step[1]) <= FP_FACTOR);
+                    lineSteps[i][j][k][0] = step[0];
+                    lineSteps[i][j][k][1] = step[1];
+                }
+            }
+        }
+        lineStepsReady = true;
+    }
+    step[0] = lineSteps[dx + DCOLS - 1][dy + DROWS - 1][offset][0];
+    step[1] = lineSteps[dx + DCOLS - 1][dy + DROWS - 1][offset][1];
+}
+
 // Generates a list of coordinates extending in a straight line
 // from originLoc (not included in the output), through targetLoc,
 // all the way to the edge of the map.
@@ -3416,145 +3476,136 @@ short getLineCoordinates(pos listOfCoordinates[], const pos originLoc, const pos
     fixpt point[2], step[2];
     short listLength;
     int score, bestScore = 0, offset, bestOffset = 0;
-
-    // Set of candidate waypoints strategically placed within a diamond shape.
-    // For why they must be within a diamond, google "diamond-exit rule".
-    const int numOffsets = 21;
-    const fixpt offsets[][2] = {
-        {50, 50}, // center of the square first (coordinates are in %)
-        {40, 40}, {60, 40}, {60, 60}, {40, 60},
-        {50, 30}, {70, 50}, {50, 70}, {30, 50},
-        {50, 20}, {80, 50}, {50, 80}, {20, 50},
-        {50, 10}, {90, 50}, {50, 90}, {10, 50},
-        {50,  1}, {99, 50}, {50, 99}, { 1, 50} };
+    pos loc;
 
     if (originLoc.x == targetLoc.x && originLoc.y == targetLoc.y) {
         listOfCoordinates[0] = INVALID_POS;
         return 0;
     }
 
-    // try all offsets; the last iteration will use the best offset found
-    for (offset = 0; offset < numOffsets + 1; offset++) {
-
-        listLength = 0;
+    // No bolt means we don't want any tuning. Returning first path (using center of target)
+    if (theBolt != NULL) {
+        creature *caster = monsterAtLoc(originLoc);
+        const boolean targetsEnemies = theBolt->flags & BF_TARGET_ENEMIES;
+        const boolean targetsAllies = theBolt->flags & BF_TARGET_ALLIES;
+        const boolean isCastByPlayer = (originLoc.x == player.loc.x && originLoc.y == player.loc.y);
 
+        // try all offsets, and evaluate each path as far as the bolt would go;
+        // we will return the path with the highest score
+        for (offset = 0; offset < LINE_OFFSET_COUNT; offset++) {
 
             // always shoot from the center of the origin cell
             point[0] = originLoc.x * FP_FACTOR + FP_FACTOR/2;
             point[1] = originLoc.y * FP_FACTOR + FP_FACTOR/2;
-            // vector to target
-            step[0] = targetLoc.x * FP_FACTOR + offsets[offset < numOffsets ? offset : bestOffset][0] * FP_FACTOR / 100 - point[0];
-            step[1] = targetLoc.y * FP_FACTOR + offsets[offset < numOffsets ? offset : bestOffset][1] * FP_FACTOR / 100 - point[1];
-
-        // normalize the step, to move exactly one row or column at a time
-        fixpt m = max(llabs(step[0]), llabs(step[1]));
-        step[0] = step[0] * FP_FACTOR / m;
-        step[1] = step[1] * FP_FACTOR / m;
-
-        // move until we exit the map
-        while (true) {
-            point[0] += step[0];
-            point[1] += step[1];
-            listOfCoordinates[listLength] = (pos){
-                .x = (point[0] < 0 ? -1 : point[0] / FP_FACTOR),
-                .y = (point[1] < 0 ? -1 : point[1] / FP_FACTOR)
-            };
-            if (!isPosInMap(listOfCoordinates[listLength])) break;
-            listLength++;
-        };
-
-        // last iteration does not need evaluation, we are returning it anyway
-        if (offset == numOffsets) break;
-
-        // No bolt means we don't want any tuning. Returning first path (using center of target)
-        if (theBolt == NULL) break;
-
-        // evaluate this path; we will return the path with the highest score
-        score = 0;
-
-        boolean passesThroughUnknown = false;
-        for (int i = 0; i < listLength; i++) {
-            short x = listOfCoordinates[i].x;
-            short y = listOfCoordinates[i].y;
-
-            boolean isImpassable = cellHasTerrainFlag((pos){ x, y }, T_OBSTRUCTS_PASSABILITY);
-            boolean isOpaque = cellHasTerrainFlag((pos){ x, y }, T_OBSTRUCTS_VISION);
-            boolean targetsEnemies = theBolt->flags & BF_TARGET_ENEMIES;
-            boolean targetsAllies = theBolt->flags & BF_TARGET_ALLIES;
-            boolean burningThrough = (theBolt->flags & BF_FIERY) && cellHasTerrainFlag((pos){ x, y }, T_IS_FLAMMABLE);
-            boolean isCastByPlayer = (originLoc.x == player.loc.x && originLoc.y == player.loc.y);
-
-            creature *caster = monsterAtLoc(originLoc);
-            creature *monst = monsterAtLoc((pos){ x, y });
-            boolean isMonster = monst
-                && !(monst->bookkeepingFlags & MB_SUBMERGED)
-                && !monsterIsHidden(monst, caster);
-            boolean isEnemyOfCaster = (monst && caster && monstersAreEnemies(monst, caster));
-            boolean isAllyOfCaster = (monst && caster && monstersAreTeammates(monst, caster));
-
-            // small bonus for making it this far
-            score += 2;
-
-            // target reached?
-            if (x == targetLoc.x && y == targetLoc.y) {
+            getLineStep(step, originLoc, targetLoc, offset);
+
+            score = 0;
+
+            boolean passesThroughUnknown = false;
+            while (true) {
+                point[0] += step[0];
+                point[1] += step[1];
+                loc = (pos){
+                    .x = (point[0] < 0 ? -1 : point[0] / FP_FACTOR),
+                    .y = (point[1] < 0 ? -1 : point[1] / FP_FACTOR)
+                };
+                if (!isPosInMap(loc)) break;
+
+                short x = loc.x;
+                short y = loc.y;
+
+                const unsigned long tFlags = terrainFlags(loc);
+                boolean isImpassable = (tFlags & T_OBSTRUCTS_PASSABILITY);
+                boolean isOpaque = (tFlags & T_OBSTRUCTS_VISION);
+                boolean burningThrough = (theBolt->flags & BF_FIERY) && (tFlags & T_IS_FLAMMABLE);
+
+                creature *monst = monsterAtLoc(loc);
+                boolean isMonster = monst
+                    && !(monst->bookkeepingFlags & MB_SUBMERGED)
+                    && !monsterIsHidden(monst, caster);
+                boolean isEnemyOfCaster = (monst && caster && monstersAreEnemies(monst, caster));
+                boolean isAllyOfCaster = (monst && caster && monstersAreTeammates(monst, caster));
+
+                // small bonus for making it this far
+                score += 2;
+
+                // target reached?
+                if (x == targetLoc.x && y == targetLoc.y) {
+
+                    if ((!targetsEnemies && !targetsAllies) ||
+                        (targetsEnemies && isMonster && isEnemyOfCaster) ||
+                        (targetsAllies && isMonster && isAllyOfCaster)) {
+
+                        // Big bonus for hitting the target, but that bonus
+                        // is lower if this path uses an unknown tile.
+                        score += passesThroughUnknown ? 2500 : 5000;
+                    }
 
-                if ((!targetsEnemies && !targetsAllies) ||
-                    (targetsEnemies && isMonster && isEnemyOfCaster) ||
-                    (targetsAllies && isMonster && isAllyOfCaster)) {
+                    break; // we don't care about anything beyond the target--if the player did, they would have selected a farther target
+                }
 
-                    // Big bonus for hitting the target, but that bonus
-                    // is lower if this path uses an unknown tile.
-                    score += passesThroughUnknown ? 2500 : 5000;
+                // if the caster is the player, undiscovered cells don't count (lest we reveal something about them)
+                if (isCastByPlayer && !(pmap[x][y].flags & (DISCOVERED | MAGIC_MAPPED))) {
+                    // Remember that this path used an unknown cell, so that a
+                    // less-risky path can be used instead if one is known.
+                    passesThroughUnknown = true;
+                    continue;
                 }
 
-                break; // we don't care about anything beyond the target--if the player did, they would have selected a farther target
-            }
+                // nothing can get through impregnable obstacles
+                if (isImpassable && pmap[x][y].flags & IMPREGNABLE) {
+                    break;
+                }
 
-            // if the caster is the player, undiscovered cells don't count (lest we reveal something about them)
-            if (isCastByPlayer && !(pmap[x][y].flags & (DISCOVERED | MAGIC_MAPPED))) {
-                // Remember that this path used an unknown cell, so that a
-                // less-risky path can be used instead if one is known.
-                passesThroughUnknown = true;
-                continue;
-            }
+                // tunneling goes through everything
+                if (theBolt->boltEffect == BE_TUNNELING) {
+                    score += (isImpassable ? 50 : isOpaque ? 10 : 0);
+                    continue;
+                }
 
-            // nothing can get through impregnable obstacles
-            if (isImpassable && pmap[x][y].flags & IMPREGNABLE) {
-                break;
-            }
+                // hitting a creature with a bolt meant for enemies
+                if (isMonster && targetsEnemies) {
+                    score += isEnemyOfCaster ? 50 : -200;
+                }
 
-            // tunneling goes through everything
-            if (theBolt->boltEffect == BE_TUNNELING) {
-                score += (isImpassable ? 50 : isOpaque ? 10 : 0);
-                continue;
-            }
+                // hitting a creature with a bolt meant for allies
+                if (isMonster && targetsAllies) {
+                    score += isAllyOfCaster ? 50 : -200;
+                }
 
-            // hitting a creature with a bolt meant for enemies
-            if (isMonster && targetsEnemies) {
-                score += isEnemyOfCaster ? 50 : -200;
-            }
+                // small penalty for setting terrain on fire (to prefer not to)
+                if (burningThrough) {
+                    score -= 1;
+                }
 
-            // hitting a creature with a bolt meant for allies
-            if (isMonster && targetsAllies) {
-                score += isAllyOfCaster ? 50 : -200;
+                // check for obstruction
+                if (isMonster && (theBolt->flags & BF_PASSES_THRU_CREATURES)) continue;
+                if (isMonster || isImpassable || (isOpaque && !burningThrough)) break;
             }
 
-            // small penalty for setting terrain on fire (to prefer not to)
-            if (burningThrough) {
-                score -= 1;
+            if (score > bestScore) {
+                bestScore = score;
+                bestOffset = offset;
             }
-
-            // check for obstruction
-            if (isMonster && (theBolt->flags & BF_PASSES_THRU_CREATURES)) continue;
-            if (isMonster || isImpassable || (isOpaque && !burningThrough)) break;
-        }
-
-        if (score > bestScore) {
-            bestScore = score;
-            bestOffset = offset;
         }
     }
 
+    // trace the chosen line all the way to the edge of the map
+    listLength = 0;
+    point[0] = originLoc.x * FP_FACTOR + FP_FACTOR/2;
+    point[1] = originLoc.y * FP_FACTOR + FP_FACTOR/2;
+    getLineStep(step, originLoc, targetLoc, bestOffset);
+    while (true) {
+        point[0] += step[0];
+        point[1] += step[1];
+        listOfCoordinates[listLength] = (pos){
+            .x = (point[0] < 0 ? -1 : point[0] / FP_FACTOR),
+            .y = (point[1] < 0 ? -1 : point[1] / FP_FACTOR)
+        };
+        if (!isPosInMap(listOfCoordinates[listLength])) break;
+        listLength++;
+    };
+
     // demarcate the end of the list
     listOfCoordinates[listLength] = INVALID_POS;
 
@@ -3641,6 +3692,7 @@ static boolean tunnelize(short x, short y) {
     freeCaptivesEmbeddedAt(x, y);
     if (x == 0 || x == DCOLS - 1 || y == 0 || y == DROWS - 1) {
         pmap[x][y].layers[DUNGEON] = CRYSTAL_WALL; // don't dissolve the boundary walls
+        markActiveTile(x, y);
         didSomething = true;
     } else {
         for (layer = 0; layer < NUMBER_TERRAIN_LAYERS; layer++) {
@@ -4160,6 +4212,7 @@ static void crystalize(short radius) {
                 if (tileCatalog[pmap[i][j].layers[DUNGEON]].flags & (T_OBSTRUCTS_PASSABILITY | T_OBSTRUCTS_VISION)) {
 
                     pmap[i][j].layers[DUNGEON] = FORCEFIELD;
+                    markActiveTile(i, j);
                     spawnDungeonFeature(i, j, &dungeonFeatureCatalog[DF_SHATTERING_SPELL], true, false);
 
                     if (pmap[i][j].flags & HAS_MONSTER) {
@@ -4173,6 +4226,7 @@ static void crystalize(short radius) {
                     }
                     if (i == 0 || i == DCOLS - 1 || j == 0 || j == DROWS - 1) {
                         pmap[i][j].layers[DUNGEON] = CRYSTAL_WALL; // boundary walls turn to crystal
+                        markActiveTile(i, j);
                     }
                 }
             }
@@ -5314,12 +5368,12 @@ boolean nextTargetAfter(const item *theItem,
         const int n = (selectedIndex + i) % targetCount;
         pos newLoc = (pos) {deduplicatedTargetList[n].x, deduplicatedTargetList[n].y};
         if ((!posEq(newLoc, player.loc) || (posEq(newLoc, player.loc) && targetMode == AUTOTARGET_MODE_EXPLORE && itemAtLoc(player.loc)))
-            && (!posEq(newLoc, targetLoc))
-            && ((targetMode == AUTOTARGET_MODE_EXPLORE) || openPathBetween(player.loc, newLoc))) {
+            && (!posEq(newLoc, targetLoc))) {
 
             brogueAssert(coordinatesAreInMap(newLoc.x, newLoc.y));
             brogueAssert(n >= 0 && n < targetCount);
             creature *const monst = monsterAtLoc(newLoc);
+            // canAutoTargetMonster() checks for an open path, after its cheaper tests
             if ((monst && canAutoTargetMonster(monst, theItem, targetMode))
                 || (targetMode == AUTOTARGET_MODE_EXPLORE)) {
 
@@ -763,6 +763,7 @@ static boolean drawManacle(pos loc, enum directions dir) {
         && pmapAt(newLoc)->layers[LIQUID] == NOTHING) {
 
         pmapAt(newLoc)->layers[SURFACE] = manacles[dir];
+        markActiveTile(newLoc.x, newLoc.y);
         return true;
     }
     return false;
@@ -1202,14 +1203,64 @@ static boolean isValidWanderDestination(creature *monst, short wpIndex) {
             && nextStep(rogue.wpDistance[wpIndex], monst->loc, monst, false) != NO_DIRECTION);
 }
 
+// The directions in which nextStep() would let the monster step from where it stands, as a bit mask.
+// None of nextStep()'s tests of a step depend on the distance map, so they can be made once for all
+// of the waypoints rather than once for each.
+static short wanderStepDirections(creature *monst) {
+    enum directions dir;
+    creature *blocker;
+    pos newLoc;
+    short directions = 0;
+
+    for (dir = 0; dir < DIRECTION_COUNT; dir++) {
+        newLoc = (pos){ monst->loc.x + nbDirs[dir][0], monst->loc.y + nbDirs[dir][1] };
+        if (!isPosInMap(newLoc)
+            || monsterAvoids(monst, newLoc)
+            || diagonalBlocked(monst->loc.x, monst->loc.y, newLoc.x, newLoc.y, monst == &player)
+            || !knownToPlayerAsPassableOrSecretDoor(newLoc)) {
+            continue;
+        }
+        blocker = monsterAtLoc(newLoc);
+        if (blocker
+            && !canPass(monst, blocker)
+            && !monstersAreTeammates(monst, blocker)
+            && !monstersAreEnemies(monst, blocker)) {
+            continue;
+        }
+        directions |= Fl(dir);
+    }
+    return directions;
+}
+
+// As isValidWanderDestination(), given the monster's wanderStepDirections().
+static boolean canWanderToward(creature *monst, short wpIndex, short directions) {
+    short **distanceMap = rogue.wpDistance[wpIndex];
+    const short here = distanceMap[monst->loc.x][monst->loc.y];
+    enum directions dir;
+    pos newLoc;
+
+    if (monst->waypointAlreadyVisited[wpIndex] || here < 0) {
+        return false;
+    }
+    for (dir = 0; dir < DIRECTION_COUNT; dir++) {
+        newLoc = (pos){ monst->loc.x + nbDirs[dir][0], monst->loc.y + nbDirs[dir][1] };
+        if ((directions & Fl(dir))
+            && here - distanceMap[newLoc.x][newLoc.y] > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 static short closestWaypointIndex(creature *monst) {
+    const short directions = wanderStepDirections(monst);
     short i, closestDistance, closestIndex;
 
     closestDistance = DCOLS/2;
     closestIndex = -1;
     for (i=0; i < rogue.wpCount; i++) {
-        if (isValidWanderDestination(monst, i)
-            && rogue.wpDistance[i][monst->loc.x][monst->loc.y] < closestDistance) {
+        if (rogue.wpDistance[i][monst->loc.x][monst->loc.y] < closestDistance
+            && canWanderToward(monst, i, directions)) {
 
             closestDistance = rogue.wpDistance[i][monst->loc.x][monst->loc.y];
             closestIndex = i;
@@ -2557,7 +2608,7 @@ static boolean generallyValidBoltTarget(creature *caster, creature *target) {
         // No bolt will affect a submerged creature. Can't shoot at invisible creatures unless it's in gas.
         return false;
     }
-    return openPathBetween(caster->loc, target->loc);
+    return true; // the caller checks for an open path last, since tracing it is the expensive part
 }
 
 static boolean targetEligibleForCombatBuff(creature *caster, creature *target) {
@@ -2773,6 +2824,19 @@ static void monsterCastSpell(creature *caster, creature *target, enum boltType b
     }
 }
 
+// Whether the monster has a bolt, other than blinking, that it would fire at the target given a clear shot.
+static boolean monsterHasBoltFor(creature *monst, creature *target) {
+    short i;
+
+    for (i = 0; monst->info.bolts[i]; i++) {
+        if (boltCatalog[monst->info.bolts[i]].boltEffect != BE_BLINKING
+            && specificallyValidBoltTarget(monst, target, monst->info.bolts[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
 // returns whether the monster cast a bolt.
 static boolean monstUseBolt(creature *monst) {
     short i;
@@ -2785,7 +2849,10 @@ static boolean monstUseBolt(creature *monst) {
     for (creatureIterator it = iterateCreatures(monsters); !handledPlayer || hasNextCreature(it);) {
         creature *target = !handledPlayer ? &player : nextCreature(&it);
         handledPlayer = true;
-        if (generallyValidBoltTarget(monst, target)) {
+        if (generallyValidBoltTarget(monst, target)
+            && monsterHasBoltFor(monst, target)
+            && openPathBetween(monst->loc, target->loc)) {
+
             for (i = 0; monst->info.bolts[i]; i++) {
                 if (boltCatalog[monst->info.bolts[i]].boltEffect == BE_BLINKING) {
                     continue; // Blinking is handled elsewhere.
@@ -1563,6 +1563,23 @@ static void displayRoute(short **distanceMap, boolean removeRoute) {
     } while (advanced);
 }
 
+// Waits between two steps of explore or travel, and returns true if the player interrupted.
+// In instant travel mode the steps are neither paused nor drawn; the input queue is still
+// polled after every step, and showInstantTravel() draws the result once at the end.
+static boolean pauseBetweenSteps(short milliseconds) {
+    if (rogue.instantTravel) {
+        return pauseBrogue(0, (PauseBehavior) { .skipScreenUpdate = true });
+    }
+    return pauseAnimation(milliseconds, PAUSE_BEHAVIOR_DEFAULT);
+}
+
+// Puts everything that happened during an instant explore or travel on screen at once.
+static void showInstantTravel(void) {
+    if (rogue.instantTravel) {
+        pauseBrogue(0, PAUSE_BEHAVIOR_DEFAULT);
+    }
+}
+
 void travelRoute(pos path[1000], short steps) {
     short i, j;
     short dir;
@@ -1596,7 +1613,7 @@ void travelRoute(pos path[1000], short steps) {
                 if (!playerMoves(dir)) {
                     rogue.disturbed = true;
                 }
-                if (pauseAnimation(25, PAUSE_BEHAVIOR_DEFAULT)) {
+                if (pauseBetweenSteps(25)) {
                     rogue.disturbed = true;
                 }
                 break;
@@ -1606,6 +1623,7 @@ void travelRoute(pos path[1000], short steps) {
     rogue.disturbed = true;
     rogue.automationActive = false;
     updateFlavorText();
+    showInstantTravel();
 }
 
 static void travelMap(short **distanceMap) {
@@ -1631,7 +1649,7 @@ static void travelMap(short **distanceMap) {
                 if (!playerMoves(dir)) {
                     rogue.disturbed = true;
                 }
-                if (pauseAnimation(500, PAUSE_BEHAVIOR_DEFAULT)) {
+                if (pauseBetweenSteps(500)) {
                     rogue.disturbed = true;
                 }
                 currentX = newX;
@@ -1644,6 +1662,7 @@ static void travelMap(short **distanceMap) {
     rogue.disturbed = true;
     rogue.automationActive = false;
     updateFlavorText();
+    showInstantTravel();
 }
 
 void travel(pos target, boolean autoConfirm) {
@@ -1731,15 +1750,16 @@ void travel(pos target, boolean autoConfirm) {
 }
 
 void populateGenericCostMap(short **costMap) {
+    const terrainSnapshot *terrain = currentTerrain();
     short i, j;
 
     for (i=0; i<DCOLS; i++) {
         for (j=0; j<DROWS; j++) {
-            if (cellHasTerrainFlag((pos){ i, j }, T_OBSTRUCTS_PASSABILITY)
-                && (!cellHasTMFlag((pos){ i, j }, TM_IS_SECRET) || (discoveredTerrainFlagsAtLoc((pos){ i, j }) & T_OBSTRUCTS_PASSABILITY))) {
+            if ((terrain->flags[i][j] & T_OBSTRUCTS_PASSABILITY)
+                && (!(terrain->mechFlags[i][j] & TM_IS_SECRET) || (terrain->discoveredFlags[i][j] & T_OBSTRUCTS_PASSABILITY))) {
 
-                costMap[i][j] = cellHasTerrainFlag((pos){ i, j }, T_OBSTRUCTS_DIAGONAL_MOVEMENT) ? PDS_OBSTRUCTION : PDS_FORBIDDEN;
-            } else if (cellHasTerrainFlag((pos){ i, j }, T_PATHING_BLOCKER & ~T_OBSTRUCTS_PASSABILITY)) {
+                costMap[i][j] = (terrain->flags[i][j] & T_OBSTRUCTS_DIAGONAL_MOVEMENT) ? PDS_OBSTRUCTION : PDS_FORBIDDEN;
+            } else if (terrain->flags[i][j] & T_PATHING_BLOCKER & ~T_OBSTRUCTS_PASSABILITY) {
                 costMap[i][j] = PDS_FORBIDDEN;
             } else {
                 costMap[i][j] = 1;
@@ -1778,6 +1798,7 @@ void getLocationFlags(const short x, const short y,
 }
 
 void populateCreatureCostMap(short **costMap, creature *monst) {
+    const terrainSnapshot *terrain = currentTerrain();
     short i, j, unexploredCellCost;
     creature *currentTenant;
     item *theItem;
@@ -1792,10 +1813,17 @@ void populateCreatureCostMap(short **costMap, creature *monst) {
                 continue;
             }
 
-            getLocationFlags(i, j, &tFlags, NULL, &cFlags, monst == &player);
+            if (monst == &player && !playerCanSee(i, j)) {
+                // as getLocationFlags(), which would read the terrain flags of every visible cell again
+                tFlags = pmap[i][j].rememberedTerrainFlags;
+                cFlags = pmap[i][j].rememberedCellFlags;
+            } else {
+                tFlags = terrain->flags[i][j];
+                cFlags = pmap[i][j].flags;
+            }
 
             if ((tFlags & T_OBSTRUCTS_PASSABILITY)
-                 && (!cellHasTMFlag((pos){ i, j }, TM_IS_SECRET) || (discoveredTerrainFlagsAtLoc((pos){ i, j }) & T_OBSTRUCTS_PASSABILITY) || monst == &player)) {
+                 && (!(terrain->mechFlags[i][j] & TM_IS_SECRET) || (terrain->discoveredFlags[i][j] & T_OBSTRUCTS_PASSABILITY) || monst == &player)) {
 
                 costMap[i][j] = (tFlags & T_OBSTRUCTS_DIAGONAL_MOVEMENT) ? PDS_OBSTRUCTION : PDS_FORBIDDEN;
                 continue;
@@ -1852,7 +1880,7 @@ void populateCreatureCostMap(short **costMap, creature *monst) {
 
             if (!(monst->info.flags & MONST_INVULNERABLE)) {
                 if ((tFlags & T_CAUSES_NAUSEA)
-                    || cellHasTMFlag((pos){ i, j }, TM_PROMOTES_ON_ITEM_PICKUP)
+                    || (terrain->mechFlags[i][j] & TM_PROMOTES_ON_ITEM_PICKUP)
                     || (tFlags & T_ENTANGLES) && !(monst->info.flags & MONST_IMMUNE_TO_WEBS)) {
 
                     costMap[i][j] += 20;
@@ -2015,7 +2043,9 @@ boolean explore(short frameDelay) {
             continue;
         }
 
-        refreshSideBar(-1, -1, false);
+        if (!rogue.instantTravel) {
+            refreshSideBar(-1, -1, false);
+        }
 
         if (dir == NO_DIRECTION) {
             rogue.disturbed = true;
@@ -2023,17 +2053,18 @@ boolean explore(short frameDelay) {
             rogue.disturbed = true;
         } else {
             madeProgress = true;
-            if (pauseAnimation(frameDelay, PAUSE_BEHAVIOR_DEFAULT)) {
+            if (pauseBetweenSteps(frameDelay)) {
 
                 rogue.disturbed = true;
                 rogue.autoPlayingLevel = false;
             }
         }
         hilitePath(path, steps, true);
-    } while (!rogue.disturbed);
+    } while (!rogue.disturbed && !rogue.gameHasEnded);
     //clearCursorPath();
     rogue.automationActive = false;
     refreshSideBar(-1, -1, false);
+    showInstantTravel();
     freeGrid(distanceMap);
     return madeProgress;
 }
@@ -0,0 +1,455 @@
+/*
+ *  RecordingBlocks.c
+ *  Brogue
+ *
+ *  This file is part of Brogue.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Packed recordings, for archiving. A packed file holds exactly the bytes of an ordinary recording,
+// cut into blocks at every level change and every RECORDING_BLOCK_TURNS turns and compressed one
+// block at a time, followed by an index giving each block's turn number and depth:
+//
+//     "BRGPACK1"
+//     for each block:  raw length (4), stored length (4), codec (1), stored bytes
+//     for each block:  file offset (4), raw offset (4), turn number (4), depth (1)
+//     block count (4), index offset (4), raw length (4), "BIDX"
+//
+// Numbers are big-endian, as in the recording header. Playback unpacks the whole file into memory
+// first, so everything downstream of recallChar() is unaware of the format. The turn numbers and
+// depths are found by replaying the recording while packing it, since nothing in the recording
+// itself says where a turn or a level begins.
+
+#include <limits.h>
+#include "Rogue.h"
+#include "GlobalsBase.h"
+#include "Globals.h"
+
+#define PACKED_RECORDING_MAGIC      "BRGPACK1"
+#define PACKED_INDEX_MAGIC          "BIDX"
+#define PACKED_MAGIC_LENGTH         8
+#define PACKED_BLOCK_HEADER_LENGTH  9
+#define PACKED_INDEX_ENTRY_LENGTH   13
+#define PACKED_TRAILER_LENGTH       16
+
+#define RECORDING_BLOCK_TURNS       1000
+
+#define LZ_MIN_MATCH                4
+#define LZ_MAX_OFFSET               65535
+#define LZ_HASH_BITS                12
+
+enum blockCodecs {
+    BLOCK_STORED,
+    BLOCK_LZ,
+};
+
+typedef struct recordingBlock {
+    unsigned long rawOffset;    // where the block starts in the unpacked recording
+    unsigned long turnNumber;   // rogue.playerTurnNumber at the start of the block
+    short depth;                // rogue.depthLevel at the start of the block
+} recordingBlock;
+
+typedef struct recordingBlockList {
+    recordingBlock *blocks;
+    unsigned long count;
+    unsigned long capacity;
+} recordingBlockList;
+
+static boolean indexingRecording = false;
+static recordingBlockList newIndex;     // being built by packRecording()
+static recordingBlockList loadedIndex;  // from the packed recording being played back
+
+static void addBlock(recordingBlockList *list, unsigned long rawOffset, unsigned long turnNumber, short depth) {
+    if (list->count == list->capacity) {
+        list->capacity = max(64, list->capacity * 2);
+        list->blocks = realloc(list->blocks, list->capacity * sizeof(recordingBlock));
+    }
+    list->blocks[list->count].rawOffset = rawOffset;
+    list->blocks[list->count].turnNumber = turnNumber;
+    list->blocks[list->count].depth = depth;
+    list->count++;
+}
+
+static void clearBlockList(recordingBlockList *list) {
+    free(list->blocks);
+    list->blocks = NULL;
+    list->count = list->capacity = 0;
+}
+
+static void writeNumber(unsigned char *to, unsigned long n, short numberOfBytes) {
+    short i;
+    for (i = numberOfBytes - 1; i >= 0; i--) {
+        to[i] = n & 0xFF;
+        n >>= 8;
+    }
+}
+
+static unsigned long readNumber(const unsigned char *from, short numberOfBytes) {
+    unsigned long n = 0;
+    short i;
+    for (i = 0; i < numberOfBytes; i++) {
+        n = (n << 8) | from[i];
+    }
+    return n;
+}
+
+// Byte-oriented LZ77. Each sequence is a token (literal count in the high nibble, match length
+// minus LZ_MIN_MATCH in the low nibble, 15 meaning "more follows in 255-saturated bytes"), the
+// literals, and a two-byte offset back to the match. The last sequence has literals only.
+// Returns the compressed size, or 0 if it would not fit in dstCapacity.
+static unsigned long lzCompress(const unsigned char *src, unsigned long length, unsigned char *dst, unsigned long dstCapacity) {
+    unsigned long hashTable[1 << LZ_HASH_BITS];
+    unsigned long pos = 0, anchor = 0, out = 0, i;
+
+    for (i = 0; i < (1 << LZ_HASH_BITS); i++) {
+        hashTable[i] = ULONG_MAX;
+    }
+
+    while (pos <= length) {
+        unsigned long matchLength = 0, offset = 0, literals, n;
+
+        if (pos + LZ_MIN_MATCH <= length) {
+            const unsigned long sequence = readNumber(&src[pos], 4);
+            const unsigned long h = (sequence * 2654435761UL & 0xFFFFFFFFUL) >> (32 - LZ_HASH_BITS);
+            const unsigned long candidate = hashTable[h];
+
+            hashTable[h] = pos;
+            if (candidate != ULONG_MAX && pos - candidate <= LZ_MAX_OFFSET
+                && readNumber(&src[candidate], 4) == sequence) {
+
+                offset = pos - candidate;
+                for (matchLength = LZ_MIN_MATCH;
+                     pos + matchLength < length && src[candidate + matchLength] == src[pos + matchLength];
+                     matchLength++);
+            }
+        }
+        if (!matchLength && pos < length) {
+            pos++;
+            continue;
+        }
+
+        // Emit the literals since the last match, then the match (if any).
+        literals = pos - anchor;
+        if (out + 1 + literals / 255 + 1 + literals + 2 + matchLength / 255 + 1 > dstCapacity) {
+            return 0;
+        }
+        dst[out++] = (min(literals, 15) << 4) | (matchLength ? min(matchLength - LZ_MIN_MATCH, 15) : 0);
+        if (literals >= 15) {
+            for (n = literals - 15; n >= 255; n -= 255) {
+                dst[out++] = 255;
+            }
+            dst[out++] = n;
+        }
+        memcpy(&dst[out], &src[anchor], literals);
+        out += literals;
+        if (!matchLength) {
+            break; // end of input
+        }
+        writeNumber(&dst[out], offset, 2);
+        out += 2;
+        if (matchLength - LZ_MIN_MATCH >= 15) {
+            for (n = matchLength - LZ_MIN_MATCH - 15; n >= 255; n -= 255) {
+                dst[out++] = 255;
+            }
+            dst[out++] = n;
+        }
+        pos += matchLength;
+        anchor = pos;
+    }
+    return out;
+}
+
+static boolean readLength(const unsigned char *src, unsigned long srcLength, unsigned long *in, unsigned long *n) {
+    unsigned char c;
+    do {
+        if (*in >= srcLength) {
+            return false;
+        }
+        c = src[(*in)++];
+        *n += c;
+    } while (c == 255);
+    return true;
+}
+
+// Returns whether src decoded to exactly length bytes. Safe on damaged input.
+static boolean lzDecompress(const unsigned char *src, unsigned long srcLength, unsigned char *dst, unsigned long length) {
+    unsigned long in = 0, out = 0, literals, matchLength, offset;
+    unsigned char token;
+
+    while (in < srcLength) {
+        token = src[in++];
+        literals = token >> 4;
+        if (literals == 15 && !readLength(src, srcLength, &in, &literals)) {
+            return false;
+        }
+        if (literals > srcLength - in || literals > length - out) {
+            return false;
+        }
+        memcpy(&dst[out], &src[in], literals);
+        in += literals;
+        out += literals;
+        if (in == srcLength) {
+            break;
+        }
+
+        if (srcLength - in < 2) {
+            return false;
+        }
+        offset = readNumber(&src[in], 2);
+        in += 2;
+        matchLength = token & 15;
+        if (matchLength == 15 && !readLength(src, srcLength, &in, &matchLength)) {
+            return false;
+        }
+        matchLength += LZ_MIN_MATCH;
+        if (offset == 0 || offset > out || matchLength > length - out) {
+            return false;
+        }
+        for (; matchLength > 0; matchLength--, out++) {
+            dst[out] = dst[out - offset]; // byte by byte, since the match may overlap itself
+        }
+    }
+    return out == length;
+}
+
+boolean isPackedRecording(const unsigned char *data, size_t length) {
+    return length >= PACKED_MAGIC_LENGTH + PACKED_TRAILER_LENGTH
+        && !memcmp(data, PACKED_RECORDING_MAGIC, PACKED_MAGIC_LENGTH);
+}
+
+// Returns the recording inside a packed file in a newly allocated buffer, or NULL if the file is
+// damaged. Its index is kept for turnOfArrivalFromIndex().
+unsigned char *unpackRecording(const unsigned char *data, size_t length, size_t *rawLength) {
+    const unsigned char *trailer = &data[length - PACKED_TRAILER_LENGTH];
+    unsigned long blockCount, indexOffset, i, blockOffset, blockRawOffset, blockRawLength, storedLength, covered = 0;
+    unsigned char *raw;
+    boolean ok = true;
+
+    clearBlockList(&loadedIndex);
+    if (!isPackedRecording(data, length) || memcmp(&trailer[12], PACKED_INDEX_MAGIC, 4)) {
+        return NULL;
+    }
+    blockCount = readNumber(&trailer[0], 4);
+    indexOffset = readNumber(&trailer[4], 4);
+    *rawLength = readNumber(&trailer[8], 4);
+    if (indexOffset > length - PACKED_TRAILER_LENGTH
+        || blockCount > (length - PACKED_TRAILER_LENGTH - indexOffset) / PACKED_INDEX_ENTRY_LENGTH
+        || !(raw = malloc(max(1, *rawLength)))) {
+        return NULL;
+    }
+
+    for (i = 0; i < blockCount && ok; i++) {
+        const unsigned char *entry = &data[indexOffset + i * PACKED_INDEX_ENTRY_LENGTH];
+        const unsigned char *block;
+
+        blockOffset = readNumber(&entry[0], 4);
+        blockRawOffset = readNumber(&entry[4], 4);
+        addBlock(&loadedIndex, blockRawOffset, readNumber(&entry[8], 4), entry[12]);
+
+        if (blockOffset > indexOffset || indexOffset - blockOffset < PACKED_BLOCK_HEADER_LENGTH) {
+            ok = false;
+            break;
+        }
+        block = &data[blockOffset];
+        blockRawLength = readNumber(&block[0], 4);
+        storedLength = readNumber(&block[4], 4);
+        if (blockRawOffset != covered || blockRawLength > *rawLength - blockRawOffset
+            || storedLength > indexOffset - blockOffset - PACKED_BLOCK_HEADER_LENGTH) {
+            ok = false;
+        } else if (block[8] == BLOCK_STORED && storedLength == blockRawLength) {
+            memcpy(&raw[blockRawOffset], &block[PACKED_BLOCK_HEADER_LENGTH], blockRawLength);
+        } else if (block[8] == BLOCK_LZ) {
+            ok = lzDecompress(&block[PACKED_BLOCK_HEADER_LENGTH], storedLength, &raw[blockRawOffset], blockRawLength);
+        } else {
+            ok = false;
+        }
+        covered += blockRawLength;
+    }
+
+    if (!ok || covered != *rawLength) {
+        free(raw);
+        clearBlockList(&loadedIndex);
+        return NULL;
+    }
+    return raw;
+}
+
+void forgetRecordingIndex() {
+    clearBlockList(&loadedIndex);
+}
+
+// If the recording being played back came with an index, looks up the turn on which the player
+// first arrived at the given depth.
+boolean turnOfArrivalFromIndex(short depth, unsigned long *turnNumber) {
+    unsigned long i;
+
+    for (i = 0; i < loadedIndex.count; i++) {
+        if (loadedIndex.blocks[i].depth == depth) {
+            *turnNumber = loadedIndex.blocks[i].turnNumber;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Called by RNGCheck() during playback, which is once per turn and once more on arriving at a level.
+void noteRecordingPosition() {
+    const recordingBlock *last;
+
+    if (!indexingRecording || !newIndex.count) {
+        return;
+    }
+    last = &newIndex.blocks[newIndex.count - 1];
+    if (recordingLocation > last->rawOffset
+        && (rogue.depthLevel != last->depth || rogue.playerTurnNumber >= last->turnNumber + RECORDING_BLOCK_TURNS)) {
+
+        addBlock(&newIndex, recordingLocation, rogue.playerTurnNumber, rogue.depthLevel);
+    }
+}
+
+// Plays the recording through without drawing anything, noting where the blocks should start.
+static void indexRecording(const char *path) {
+    clearBlockList(&newIndex);
+    addBlock(&newIndex, 0, 0, 1);
+    indexingRecording = true;
+
+    if (playRecordingHeadless(path)) {
+        freeEverything();
+        releasePlaybackFile();
+    }
+
+    indexingRecording = false;
+    rogue.playbackMode = false;
+    rogue.playbackFastForward = false;
+}
+
+static boolean writeAll(FILE *file, const void *data, size_t length) {
+    return fwrite(data, 1, length, file) == length;
+}
+
+// Reads back a freshly packed file and checks that it unpacks to the original.
+static boolean packedFileMatches(const char *path, const unsigned char *raw, size_t rawLength) {
+    const unsigned char *packed;
+    unsigned char *unpacked = NULL;
+    size_t packedLength, unpackedLength = 0;
+    boolean matches;
+
+    packed = mapFileForReading(path, &packedLength);
+    if (packed) {
+        unpacked = unpackRecording(packed, packedLength, &unpackedLength);
+        unmapFile(packed, packedLength);
+    }
+    matches = unpacked && unpackedLength == rawLength && !memcmp(unpacked, raw, rawLength);
+    free(unpacked);
+    forgetRecordingIndex();
+    return matches;
+}
+
+// Writes inPath, an ordinary recording or saved game, to outPath as a packed recording.
+int packRecording(const char *inPath, const char *outPath, char *errorMessage) {
+    const unsigned char *raw;
+    unsigned char *stored, header[PACKED_TRAILER_LENGTH];
+    size_t rawLength;
+    unsigned long i, fileOffset, *blockOffsets, storedLength, blockLength;
+    FILE *outFile;
+    boolean ok = true;
+
+    rogue.nextGame = NG_NOTHING;
+    initializeGameVariant();
+    errorMessage[0] = '\0';
+
+    raw = mapFileForReading(inPath, &rawLength);
+    if (!raw) {
+        snprintf(errorMessage, ERROR_MESSAGE_LENGTH, "could not read %s", inPath);
+        return 1;
+    }
+    if (isPackedRecording(raw, rawLength)) {
+        unmapFile(raw, rawLength);
+        snprintf(errorMessage, ERROR_MESSAGE_LENGTH, "%s is already packed", inPath);
+        return 1;
+    }
+
+    indexRecording(inPath);
+    if (rogue.playbackOOS && recordingLocation < rawLength) {
+        fprintf(stderr, "Playback went out of sync at turn %lu; blocks after that are not indexed.\n",
+                rogue.playerTurnNumber);
+    }
+
+    outFile = fopen(outPath, "wb");
+    if (!outFile) {
+        unmapFile(raw, rawLength);
+        clearBlockList(&newIndex);
+        snprintf(errorMessage, ERROR_MESSAGE_LENGTH, "could not write %s", outPath);
+        return 1;
+    }
+
+    blockOffsets = malloc(newIndex.count * sizeof(unsigned long));
+    ok = writeAll(outFile, PACKED_RECORDING_MAGIC, PACKED_MAGIC_LENGTH);
+    fileOffset = PACKED_MAGIC_LENGTH;
+    for (i = 0; i < newIndex.count && ok; i++) {
+        const unsigned long start = newIndex.blocks[i].rawOffset;
+        const unsigned long end = (i + 1 < newIndex.count ? newIndex.blocks[i + 1].rawOffset : rawLength);
+
+        blockLength = (end > start ? end - start : 0);
+        stored = malloc(max(1, blockLength));
+        storedLength = lzCompress(&raw[start], blockLength, stored, blockLength);
+
+        writeNumber(&header[0], blockLength, 4);
+        if (storedLength && storedLength < blockLength) {
+            writeNumber(&header[4], storedLength, 4);
+            header[8] = BLOCK_LZ;
+        } else {
+            storedLength = blockLength;
+            memcpy(stored, &raw[start], blockLength);
+            writeNumber(&header[4], storedLength, 4);
+            header[8] = BLOCK_STORED;
+        }
+        ok = writeAll(outFile, header, PACKED_BLOCK_HEADER_LENGTH) && writeAll(outFile, stored, storedLength);
+        free(stored);
+
+        blockOffsets[i] = fileOffset;
+        fileOffset += PACKED_BLOCK_HEADER_LENGTH + storedLength;
+    }
+
+    for (i = 0; i < newIndex.count && ok; i++) {
+        writeNumber(&header[0], blockOffsets[i], 4);
+        writeNumber(&header[4], newIndex.blocks[i].rawOffset, 4);
+        writeNumber(&header[8], newIndex.blocks[i].turnNumber, 4);
+        header[12] = newIndex.blocks[i].depth;
+        ok = writeAll(outFile, header, PACKED_INDEX_ENTRY_LENGTH);
+    }
+    writeNumber(&header[0], newIndex.count, 4);
+    writeNumber(&header[4], fileOffset, 4);
+    writeNumber(&header[8], rawLength, 4);
+    memcpy(&header[12], PACKED_INDEX_MAGIC, 4);
+    ok = ok && writeAll(outFile, header, PACKED_TRAILER_LENGTH);
+    ok = (fclose(outFile) == 0) && ok;
+
+    if (ok && !packedFileMatches(outPath, raw, rawLength)) {
+        snprintf(errorMessage, ERROR_MESSAGE_LENGTH, "%s did not unpack to the original", outPath);
+        ok = false;
+    } else if (ok) {
+        printf("Packed %s into %s: %lu blocks, %lu bytes down to %lu.\n",
+               inPath, outPath, newIndex.count, (unsigned long) rawLength,
+               fileOffset + newIndex.count * PACKED_INDEX_ENTRY_LENGTH + PACKED_TRAILER_LENGTH);
+    } else if (!errorMessage[0]) {
+        snprintf(errorMessage, ERROR_MESSAGE_LENGTH, "could not write %s", outPath);
+    }
+
+    free(blockOffsets);
+    clearBlockList(&newIndex);
+    unmapFile(raw, rawLength);
+    return ok ? 0 : 1;
+}
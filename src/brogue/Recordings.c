@@ -35,6 +35,22 @@ static const long keystrokeTable[] = {UP_ARROW, LEFT_ARROW, DOWN_ARROW, RIGHT_AR
 
 static const int keystrokeCount = sizeof(keystrokeTable) / sizeof(*keystrokeTable);
 
+// While recording, the file stays open behind a large stdio buffer. Bytes move from inputRecordBuffer
+// into the stream as they accumulate, and the header is only rewritten by flushBufferToFile(), so a
+// recording cut short by a crash is still valid up to the last level change.
+static FILE *recordingStream = NULL;
+static char recordingStreamPath[BROGUE_FILENAME_MAX];
+
+// During playback the whole file is mapped when the platform allows it, and recallChar() reads
+// from the mapping at recordingLocation instead of refilling inputRecordBuffer from the file.
+static const unsigned char *playbackMapping = NULL;
+static size_t playbackMappingLength;
+static boolean playbackMappingIsUnpacked = false; // a packed recording, unpacked into memory we own
+static boolean playbackFileDamaged = false;       // a packed recording that could not be unpacked
+
+// What the last failed playback check found, kept for --verify-recordings.
+static char playbackProblem[COLS];
+
 enum recordingSeekModes {
     RECORDING_SEEK_MODE_TURN,
     RECORDING_SEEK_MODE_DEPTH
@@ -49,9 +65,49 @@ static void recordChar(unsigned char c) {
     }
 }
 
+void closeRecordingStream() {
+    if (recordingStream) {
+        syncFile(recordingStream);
+        fclose(recordingStream);
+        recordingStream = NULL;
+    }
+}
+
+static FILE *openRecordingStream() {
+    if (recordingStream && strcmp(recordingStreamPath, currentFilePath)) {
+        closeRecordingStream(); // the game has moved on to another file
+    }
+    if (!recordingStream) {
+        recordingStream = fopen(currentFilePath, "r+b");
+        if (!recordingStream) {
+            recordingStream = fopen(currentFilePath, "w+b");
+        }
+        if (recordingStream) {
+            setvbuf(recordingStream, NULL, _IOFBF, recordingStreamBufferSize);
+            strcpy(recordingStreamPath, currentFilePath);
+        }
+    }
+    return recordingStream;
+}
+
+// Moves the recorded bytes into the stream, which only touches the disk when its own buffer fills.
+static void appendBufferToStream() {
+    FILE *recordFile;
+
+    if (locationInRecordingBuffer != 0
+        && currentFilePath[0] != '\0'
+        && (recordFile = openRecordingStream())) {
+
+        fseek(recordFile, 0, SEEK_END);
+        fwrite(inputRecordBuffer, 1, locationInRecordingBuffer, recordFile);
+    }
+    lengthOfPlaybackFile += locationInRecordingBuffer;
+    locationInRecordingBuffer = 0;
+}
+
 static void considerFlushingBufferToFile() {
-    if (locationInRecordingBuffer >= INPUT_RECORD_BUFFER) {
-        flushBufferToFile();
+    if (locationInRecordingBuffer >= INPUT_RECORD_BUFFER && !rogue.playbackMode) {
+        appendBufferToStream();
     }
 }
 
@@ -174,10 +230,18 @@ void recordMouseClick(short x, short y, boolean controlKey, boolean shiftKey) {
     recordEvent(&theEvent);
 }
 
-static void writeHeaderInfo(char *path) {
+// Prefixed to the version in the header of a recording that holds state hashes. Versions that don't
+// know the STATE_HASH event then refuse the file as being from another version, rather than
+// stopping at the first hash with "Unrecognized event type".
+#define STATE_HASH_VERSION_MARK "H:"
+
+static boolean versionHasStateHashes(const char *versionString) {
+    return strncmp(versionString, STATE_HASH_VERSION_MARK, strlen(STATE_HASH_VERSION_MARK)) == 0;
+}
+
+static void writeHeaderInfo(FILE *recordFile) {
     unsigned char c[RECORDING_HEADER_LENGTH];
     short i;
-    FILE *recordFile;
 
     // Zero out the entire header to start.
     for (i=0; i<RECORDING_HEADER_LENGTH; i++) {
@@ -185,6 +249,11 @@ static void writeHeaderInfo(char *path) {
     }
 
     // Note the version string to gracefully deny compatibility when necessary.
+    if (stateHashPolicy != STATE_HASHES_OFF && !versionHasStateHashes(rogue.versionString)) {
+        char marked[sizeof(STATE_HASH_VERSION_MARK) + sizeof(rogue.versionString)];
+        sprintf(marked, STATE_HASH_VERSION_MARK "%s", rogue.versionString);
+        memcpy(rogue.versionString, marked, sizeof(rogue.versionString) - 1); // the last byte stays '\0'
+    }
     for (i = 0; rogue.versionString[i] != '\0'; i++) {
         c[i] = rogue.versionString[i];
     }
@@ -199,20 +268,9 @@ static void writeHeaderInfo(char *path) {
     numberToString(lengthOfPlaybackFile, 4, &c[i]);
     i += 4;
 
-    if (!fileExists(path)) {
-        recordFile = fopen(path, "wb");
-        if (recordFile) {
-            fclose(recordFile);
-        }
-    }
-
-    recordFile = fopen(path, "r+b");
-    rewind(recordFile);
-    for (i=0; i<RECORDING_HEADER_LENGTH; i++) {
-        putc(c[i], recordFile);
-    }
     if (recordFile) {
-        fclose(recordFile);
+        rewind(recordFile);
+        fwrite(c, 1, RECORDING_HEADER_LENGTH, recordFile);
     }
 
     if (lengthOfPlaybackFile < RECORDING_HEADER_LENGTH) {
@@ -220,38 +278,79 @@ static void writeHeaderInfo(char *path) {
     }
 }
 
+// Writes out everything recorded so far and a header that covers it. Syncing to disk follows
+// recordingSyncPolicy; this is called once per level and at the end of the game, and once per
+// turn under RECORDING_SYNC_TURN.
 void flushBufferToFile() {
+    FILE *recordFile;
+
     if (rogue.playbackMode) {
         return;
     }
 
     if (!currentFilePath[0] == '\0') {
-        short i;
-        FILE *recordFile;
-
         lengthOfPlaybackFile += locationInRecordingBuffer;
-        writeHeaderInfo(currentFilePath);
-
-        if (locationInRecordingBuffer != 0) {
+        recordFile = openRecordingStream();
+        writeHeaderInfo(recordFile);
 
-            recordFile = fopen(currentFilePath, "ab");
-
-            for (i=0; i<locationInRecordingBuffer; i++) {
-                putc(inputRecordBuffer[i], recordFile);
+        if (recordFile) {
+            if (locationInRecordingBuffer != 0) {
+                fseek(recordFile, 0, SEEK_END);
+                fwrite(inputRecordBuffer, 1, locationInRecordingBuffer, recordFile);
             }
-
-            if (recordFile) {
-                fclose(recordFile);
+            if (recordingSyncPolicy == RECORDING_SYNC_EXIT) {
+                fflush(recordFile); // out of our process at least
+            } else {
+                syncFileInBackground(recordFile);
             }
         }
     }
     locationInRecordingBuffer = 0;
 }
 
+void releasePlaybackFile() {
+    if (playbackMapping) {
+        if (playbackMappingIsUnpacked) {
+            free((void *) playbackMapping);
+        } else {
+            unmapFile(playbackMapping, playbackMappingLength);
+        }
+        playbackMapping = NULL;
+    }
+    playbackMappingIsUnpacked = false;
+    playbackFileDamaged = false;
+    forgetRecordingIndex();
+}
+
+static void mapPlaybackFile() {
+    unsigned char *unpacked;
+    size_t unpackedLength;
+
+    releasePlaybackFile();
+    playbackMapping = mapFileForReading(currentFilePath, &playbackMappingLength);
+    if (playbackMapping && isPackedRecording(playbackMapping, playbackMappingLength)) {
+        unpacked = unpackRecording(playbackMapping, playbackMappingLength, &unpackedLength);
+        unmapFile(playbackMapping, playbackMappingLength);
+        playbackMapping = unpacked;
+        playbackMappingLength = unpackedLength;
+        playbackMappingIsUnpacked = (unpacked != NULL);
+        playbackFileDamaged = (unpacked == NULL); // initRecording() refuses to play it
+    }
+}
+
 void fillBufferFromFile() {
 //  short i;
     FILE *recordFile;
 
+    if (positionInPlaybackFile == 0) {
+        // Starting from the top of a file, which may not be the one we had before: map it afresh.
+        mapPlaybackFile();
+    }
+    if (playbackMapping || playbackFileDamaged) {
+        locationInRecordingBuffer = 0;
+        return; // never read a packed file as raw events
+    }
+
     recordFile = fopen(currentFilePath, "rb");
     fseek(recordFile, positionInPlaybackFile, SEEK_SET);
 
@@ -265,9 +364,14 @@ void fillBufferFromFile() {
 
 static unsigned char recallChar() {
     unsigned char c;
-    if (recordingLocation > lengthOfPlaybackFile) {
+    if (recordingLocation > lengthOfPlaybackFile || playbackFileDamaged) {
         return END_OF_RECORDING;
     }
+    if (playbackMapping) {
+        c = (recordingLocation < playbackMappingLength ? playbackMapping[recordingLocation] : END_OF_RECORDING);
+        recordingLocation++;
+        return c;
+    }
     c = inputRecordBuffer[locationInRecordingBuffer++];
     recordingLocation++;
     if (locationInRecordingBuffer >= INPUT_RECORD_BUFFER) {
@@ -283,6 +387,17 @@ static long uncompressKeystroke(unsigned char c) {
     return (long)c;
 }
 
+// The next character recallChar() would return, without moving past it.
+static unsigned char peekChar() {
+    if (recordingLocation >= lengthOfPlaybackFile || playbackFileDamaged) {
+        return END_OF_RECORDING;
+    }
+    if (playbackMapping) {
+        return (recordingLocation < playbackMappingLength ? playbackMapping[recordingLocation] : END_OF_RECORDING);
+    }
+    return inputRecordBuffer[locationInRecordingBuffer];
+}
+
 static uint64_t recallNumber(short numberOfBytes) {
     short i;
     uint64_t n;
@@ -302,8 +417,32 @@ simply be the result of a bug.\n\n\
 If this is a different computer from the one on which the recording was saved, the recording \
 might succeed on the original computer."
 
+// Prints what a playback check found (unless we are verifying recordings in a batch, where it
+// goes into the report instead) and remembers it for the report.
+static void notePlaybackProblem(const char *problem) {
+    strncpy(playbackProblem, problem, sizeof(playbackProblem) - 1);
+    playbackProblem[sizeof(playbackProblem) - 1] = '\0';
+    if (!autoplayBatch) {
+        printf("%s\n", problem);
+    }
+}
+
 static void playbackPanic() {
 
+    if (autoplayBatch && !rogue.playbackOOS) {
+        // Running out of input is how a saved game (as opposed to a finished one) ends.
+        rogue.playbackOOS = true;
+        rogue.gameHasEnded = true;
+        if (recordingLocation - 1 >= lengthOfPlaybackFile) {
+            noteAutoplayOutcome("unfinished", "");
+            rogue.gameExitStatusCode = EXIT_STATUS_SUCCESS;
+        } else {
+            noteAutoplayOutcome("out of sync", playbackProblem);
+            rogue.gameExitStatusCode = EXIT_STATUS_FAILURE_RECORDING_OOS;
+        }
+        return;
+    }
+
     if (!rogue.playbackOOS) {
         rogue.playbackFastForward = false;
         rogue.playbackPaused = true;
@@ -340,6 +479,7 @@ static void playbackPanic() {
 void recallEvent(rogueEvent *event) {
     unsigned char c;
     boolean tryAgain;
+    char buf[COLS];
 
     do {
         tryAgain = false;
@@ -369,7 +509,8 @@ void recallEvent(rogueEvent *event) {
             case EVENT_ERROR:
             default:
                 message("Unrecognized event type in playback.", REQUIRE_ACKNOWLEDGMENT);
-                printf("Unrecognized event type in playback: event ID %i", c);
+                sprintf(buf, "Unrecognized event type in playback: event ID %i", c);
+                notePlaybackProblem(buf);
                 tryAgain = true;
                 playbackPanic();
                 break;
@@ -460,6 +601,28 @@ static boolean getPatchVersion(char *versionString, unsigned short *patchVersion
     return sscanf(versionString, gameConst->patchVersionPattern, patchVersion) == 1;
 }
 
+// Gives up on playing back a file that can't be played, saying why in the way that suits how it is
+// being played, and ends the game with the given exit status.
+static void refusePlayback(const char *outcome, const char *detail, char *explanation, enum exitStatus status) {
+    rogue.playbackMode = false;
+    rogue.playbackFastForward = false;
+
+    if (autoplayBatch) {
+        noteAutoplayOutcome(outcome, detail);
+    } else if (!nonInteractivePlayback) {
+        dialogAlert(explanation);
+    } else {
+        printf("%s", explanation);
+    }
+
+    rogue.playbackMode = true;
+    rogue.playbackPaused = true;
+    rogue.playbackFastForward = false;
+    rogue.playbackOOS = false;
+    rogue.gameHasEnded = true;
+    rogue.gameExitStatusCode = status;
+}
+
 // creates a game recording file, or if in playback mode,
 // initializes based on and starts reading from the recording file
 void initRecording() {
@@ -470,7 +633,7 @@ void initRecording() {
     short i;
     enum gameMode mode;
     unsigned short recPatch;
-    char buf[1000], *versionString = rogue.versionString;
+    char buf[1000], *versionString = rogue.versionString, *recordedVersion;
     FILE *recordFile;
 
 #ifdef AUDIT_RNG
@@ -503,28 +666,22 @@ void initRecording() {
             versionString[i] = recallChar();
         }
         rogue.mode = recallChar();
-
-        if (getPatchVersion(versionString, &recPatch) && recPatch <= gameConst->patchVersion) {
+        recordedVersion = versionString + (versionHasStateHashes(versionString) ? strlen(STATE_HASH_VERSION_MARK) : 0);
+
+        if (playbackFileDamaged) {
+            // A packed recording that wouldn't unpack; everything recalled from it is END_OF_RECORDING.
+            strcpy(buf, "This recording is damaged and cannot be played.");
+            refusePlayback("damaged", "the packed recording could not be unpacked", buf,
+                           EXIT_STATUS_FAILURE_RECORDING_DAMAGED);
+        } else if (getPatchVersion(recordedVersion, &recPatch) && recPatch <= gameConst->patchVersion) {
             // Major and Minor match ours, Patch is less than or equal to ours: we are compatible.
             rogue.patchVersion = recPatch;
-        } else if (strcmp(versionString, gameConst->recordingVersionString) != 0) {
+        } else if (strcmp(recordedVersion, gameConst->recordingVersionString) != 0) {
             // We have neither a compatible pattern match nor an exact match: we cannot load it.
-            rogue.playbackMode = false;
-            rogue.playbackFastForward = false;
-
-            if (!nonInteractivePlayback) {
-                snprintf(buf, 1000, "This file is from version %s and cannot be opened in version %s.", versionString, gameConst->versionString);
-                dialogAlert(buf);
-            } else {
-                printf("This file is from version %s and cannot be opened in version %s.", versionString, gameConst->versionString);
-            }
-
-            rogue.playbackMode = true;
-            rogue.playbackPaused = true;
-            rogue.playbackFastForward = false;
-            rogue.playbackOOS = false;
-            rogue.gameHasEnded = true;
-            rogue.gameExitStatusCode = EXIT_STATUS_FAILURE_RECORDING_WRONG_VERSION;
+            char detail[100];
+            snprintf(detail, sizeof(detail), "recorded by version %s", versionString);
+            snprintf(buf, 1000, "This file is from version %s and cannot be opened in version %s.", versionString, gameConst->versionString);
+            refusePlayback("wrong version", detail, buf, EXIT_STATUS_FAILURE_RECORDING_WRONG_VERSION);
         }
 
         rogue.seed              = recallNumber(8);          // master random seed
@@ -545,6 +702,8 @@ void initRecording() {
         strcpy(versionString, gameConst->recordingVersionString);
 
         lengthOfPlaybackFile = 1;
+        releasePlaybackFile();
+        closeRecordingStream();
         remove(currentFilePath);
         recordFile = fopen(currentFilePath, "wb"); // create the file
         fclose(recordFile);
@@ -558,16 +717,18 @@ void initRecording() {
 void OOSCheck(unsigned long x, short numberOfBytes) {
     unsigned char eventType;
     unsigned long recordedNumber;
+    char buf[COLS];
 
     if (rogue.playbackMode) {
         eventType = recallChar();
         recordedNumber = recallNumber(numberOfBytes);
         if (eventType != RNG_CHECK || recordedNumber != x) {
             if (eventType != RNG_CHECK) {
-                printf("Event type mismatch in RNG check.\n");
+                notePlaybackProblem("Event type mismatch in RNG check.");
                 playbackPanic();
             } else if (recordedNumber != x) {
-                printf("Expected RNG output of %li; got %i.\n", recordedNumber, (int) x);
+                sprintf(buf, "Expected RNG output of %li; got %i.", recordedNumber, (int) x);
+                notePlaybackProblem(buf);
                 playbackPanic();
             }
         }
@@ -592,10 +753,55 @@ void RNGCheck() {
 
     randomNumber = (unsigned long) rand_range(0, 255);
     OOSCheck(randomNumber, 1);
+    stateHashCheck(false);
+
+    if (rogue.playbackMode) {
+        noteRecordingPosition();
+    }
+
+    if (recordingSyncPolicy == RECORDING_SYNC_TURN) {
+        flushBufferToFile();
+    }
 
     rogue.RNG = oldRNG;
 }
 
+// Records the state hashes, if the policy calls for them here, or during playback compares them
+// with any that the recording holds at this point. Recordings made without hashes, or with them
+// only at level boundaries, play back as before.
+void stateHashCheck(boolean levelBoundary) {
+    uint32_t hashes[NUMBER_OF_STATE_HASH_COMPONENTS];
+    unsigned long recordedHash;
+    short i, count;
+    char buf[COLS];
+
+    if (rogue.playbackMode) {
+        if (peekChar() != STATE_HASH) {
+            return;
+        }
+        recallChar();
+        count = recallChar();
+        computeStateHashes(hashes);
+        for (i = 0; i < count; i++) {
+            recordedHash = recallNumber(4);
+            if (i < NUMBER_OF_STATE_HASH_COMPONENTS && recordedHash != hashes[i] && !rogue.playbackOOS) {
+                sprintf(buf, "State hash mismatch on turn %lu: %s differs.",
+                        rogue.playerTurnNumber, stateHashComponentName(i));
+                notePlaybackProblem(buf);
+                playbackPanic();
+            }
+        }
+    } else if (stateHashPolicy == (levelBoundary ? STATE_HASHES_LEVEL : STATE_HASHES_TURN)) {
+        computeStateHashes(hashes);
+        recordChar(STATE_HASH);
+        recordChar(NUMBER_OF_STATE_HASH_COMPONENTS);
+        for (i = 0; i < NUMBER_OF_STATE_HASH_COMPONENTS; i++) {
+            recordNumber(hashes[i], 4);
+        }
+        considerFlushingBufferToFile();
+    }
+}
+
 static boolean unpause() {
     if (rogue.playbackOOS) {
         flashTemporaryAlert(" Out of sync ", 2000);
@@ -707,6 +913,8 @@ static void seek(unsigned long seekTarget, enum recordingSeekModes seekMode) {
                 startTurnNumber = rogue.playerTurnNumber;
                 targetTurnNumber = rogue.playerTurnNumber + avgTurnsPerLevel;
             }
+            turnOfArrivalFromIndex(seekTarget, &targetTurnNumber); // exact, for packed recordings
+
             break;
         case RECORDING_SEEK_MODE_TURN :
             if (seekTarget < rogue.playerTurnNumber) {
@@ -1169,6 +1377,7 @@ void saveGameNoPrompt() {
     getDefaultFilePath(defaultPath, false);
     getAvailableFilePath(filePath, defaultPath, GAME_SUFFIX);
     flushBufferToFile();
+    closeRecordingStream();
     strcat(filePath, GAME_SUFFIX);
     rename(currentFilePath, filePath);
     strcpy(currentFilePath, filePath);
@@ -1198,6 +1407,7 @@ void saveGame() {
             if (!fileExists(filePath) || confirm("File of that name already exists. Overwrite?", true)) {
                 remove(filePath);
                 flushBufferToFile();
+                closeRecordingStream();
                 rename(currentFilePath, filePath);
                 strcpy(currentFilePath, filePath);
                 rogue.recording = false;
@@ -1220,6 +1430,7 @@ void saveRecordingNoPrompt(char *filePath) {
     getAvailableFilePath(filePath, defaultPath, RECORDING_SUFFIX);
     strcat(filePath, RECORDING_SUFFIX);
     remove(filePath);
+    closeRecordingStream();
     rename(currentFilePath, filePath);
     rogue.recording = false;
 }
@@ -1235,6 +1446,7 @@ void saveRecording(char *filePathWithoutSuffix) {
     getDefaultFilePath(defaultPath, true);
     getAvailableFilePath(filePathWithoutSuffix, defaultPath, RECORDING_SUFFIX);
     filePath[0] = '\0';
+    closeRecordingStream();
 
     do {
         askAgain = false;
@@ -1280,6 +1492,17 @@ static void copyFile(char *fromFilePath, char *toFilePath, unsigned long fromFil
     fclose(toFile);
 }
 
+static void writeFileFromMemory(char *toFilePath, const unsigned char *data, unsigned long length) {
+    FILE *toFile;
+
+    remove(toFilePath);
+    toFile = fopen(toFilePath, "wb");
+    if (toFile) {
+        fwrite(data, 1, length, toFile);
+        fclose(toFile);
+    }
+}
+
 // at the end of loading a saved game, this function transitions into active play mode.
 void switchToPlaying() {
     char lastGamePath[BROGUE_FILENAME_MAX];
@@ -1292,7 +1515,13 @@ void switchToPlaying() {
     rogue.playbackOmniscience   = false;
     rogue.recording             = true;
     locationInRecordingBuffer   = 0;
-    copyFile(currentFilePath, lastGamePath, recordingLocation);
+    if (playbackMappingIsUnpacked) {
+        // The file itself is packed; carry on from the recording inside it.
+        writeFileFromMemory(lastGamePath, playbackMapping, min(recordingLocation, playbackMappingLength));
+    } else {
+        copyFile(currentFilePath, lastGamePath, recordingLocation);
+    }
+    releasePlaybackFile();
 #ifndef ENABLE_PLAYBACK_SWITCH
     if (DELETE_SAVE_FILE_AFTER_LOADING) {
         remove(currentFilePath);
@@ -1438,7 +1667,7 @@ void parseFile() {
     uint64_t seed;
     unsigned char c;
     char description[1000], versionString[500];
-    short x, y;
+    short x, y, j;
 
     if (selectFile("Parse recording: ", "Recording.broguerec", "")) {
 
@@ -1493,6 +1722,14 @@ void parseFile() {
                 case SAVED_GAME_LOADED:
                     strcpy(description, "Saved game loaded");
                     break;
+                case STATE_HASH:
+                    j = recallChar();
+                    strcpy(description, "\tState hashes:");
+                    for (; j > 0; j--) {
+                        snprintf(description + strlen(description), sizeof(description) - strlen(description),
+                                 " %08lx", (unsigned long) recallNumber(4));
+                    }
+                    break;
                 default:
                     sprintf(description, "UNKNOWN EVENT TYPE: %i", (short) c);
                     break;
@@ -1517,3 +1754,33 @@ void RNGLog(char *message) {
     fputs(message, RNGLogFile);
 #endif
 }
+
+// Plays the recording or saved game at path from start to finish as fast as possible, without
+// drawing anything and without stopping for the player. Returns false if the file could not be opened.
+boolean playRecordingHeadless(const char *path) {
+    rogueEvent theEvent;
+
+    playbackProblem[0] = '\0';
+    if (!openFile(path)) {
+        return false;
+    }
+
+    strcpy(rogue.currentGamePath, path);
+    randomNumbersGenerated = 0;
+    rogue.playbackMode = true;
+    initializeRogue(0); // Seed argument is ignored because we're in playback.
+    if (!rogue.gameHasEnded) {
+        rogue.playbackFastForward = true;
+        startLevel(rogue.depthLevel, 1);
+        rogue.playbackPaused = false;
+    }
+    while (!rogue.gameHasEnded && rogue.playbackMode) {
+        rogue.RNG = RNG_COSMETIC;
+        rogue.playbackBetweenTurns = true;
+        rogue.playbackDelayThisTurn = 0;
+        nextBrogueEvent(&theEvent, false, true, false);
+        rogue.RNG = RNG_SUBSTANTIVE;
+        executeEvent(&theEvent);
+    }
+    return true;
+}
@@ -59,6 +59,7 @@
 #define D_SAFETY_VISION                 (WIZARD_MODE && 0)
 #define D_SCENT_VISION                  (WIZARD_MODE && 0)
 #define D_OMNISCENCE                    (WIZARD_MODE && 0)
+#define D_VALIDATE_DISPLAY_CACHE        (WIZARD_MODE && 0)
 
 #define D_INSPECT_LEVELGEN              (WIZARD_MODE && 0)
 #define D_INSPECT_MACHINES              (WIZARD_MODE && 0)
@@ -69,6 +70,9 @@
 // If enabled, runs a benchmark for the performance of repeatedly updating the screen at the start of the game.
 // #define SCREEN_UPDATE_BENCHMARK
 
+// If enabled, times full-map cell appearance passes and screen overlays whenever a level is started.
+// #define APPEARANCE_BENCHMARK
+
 // If enabled, logs the light values when '~' is pressed.
 // #define LOG_LIGHTS
 
@@ -187,6 +191,7 @@ typedef struct windowpos {
 
 #define INPUT_RECORD_BUFFER     1000        // the threshold size before flushing the record buffer to disk
 #define INPUT_RECORD_BUFFER_MAX_SIZE 1100   // the maximum size of the record buffer
+#define RECORDING_STREAM_BUFFER 65536       // default size of the stdio buffer in front of the open recording file
 #define DEFAULT_PLAYBACK_DELAY  50
 
 #define HIGH_SCORES_COUNT       30
@@ -356,6 +361,7 @@ enum eventTypes {
     SAVED_GAME_LOADED,
     END_OF_RECORDING,
     EVENT_ERROR,
+    STATE_HASH,
     NUMBER_OF_EVENT_TYPES, // unused
 };
 
@@ -1186,6 +1192,7 @@ enum tileFlags {
 #define SWAP_KEY            'w'
 #define TRUE_COLORS_KEY     '\\'
 #define STEALTH_RANGE_KEY   ']'
+#define INSTANT_TRAVEL_KEY  '['
 #define DROP_KEY            'd'
 #define CALL_KEY            'c'
 #define QUIT_KEY            'Q'
@@ -2352,11 +2359,36 @@ enum featTypes {
     FEAT_TONE
 };
 
+// How often the recording file is forced out to disk. The game never waits for it except when the
+// recording is closed; otherwise the sync happens on a helper thread where the platform has one.
+enum recordingSyncPolicies {
+    RECORDING_SYNC_TURN,    // after every player turn
+    RECORDING_SYNC_LEVEL,   // whenever a level is entered
+    RECORDING_SYNC_EXIT,    // only when the recording is closed
+};
+
+// How often a recording carries hashes of the game state, which playback compares against its own.
+enum stateHashPolicies {
+    STATE_HASHES_OFF,
+    STATE_HASHES_TURN,      // after every player turn
+    STATE_HASHES_LEVEL,     // whenever a level is entered
+};
+
+enum stateHashComponents {
+    STATE_HASH_RNG,
+    STATE_HASH_PLAYER,
+    STATE_HASH_MONSTERS,
+    STATE_HASH_ITEMS,
+    STATE_HASH_DUNGEON,
+    NUMBER_OF_STATE_HASH_COMPONENTS,
+};
+
 enum exitStatus {
     EXIT_STATUS_SUCCESS,
     EXIT_STATUS_FAILURE_RECORDING_WRONG_VERSION,
     EXIT_STATUS_FAILURE_RECORDING_OOS,
-    EXIT_STATUS_FAILURE_PLATFORM_ERROR
+    EXIT_STATUS_FAILURE_PLATFORM_ERROR,
+    EXIT_STATUS_FAILURE_RECORDING_DAMAGED
 };
 
 // Constants for the selected game variant, set in Globals{variant}.c
@@ -2462,11 +2494,13 @@ typedef struct playerCharacter {
     boolean trueColorMode;              // whether lighting effects are disabled
     boolean hideSeed;                   // whether seed is hidden when pressing SEED_KEY
     boolean displayStealthRangeMode;    // whether your stealth range is displayed
+    boolean instantTravel;              // whether explore and travel skip drawing and pausing between steps
     boolean quit;                       // to skip the typical end-game theatrics when the player quits
     uint64_t seed;                      // the master seed for generating the entire dungeon
     short RNG;                          // which RNG are we currently using?
     unsigned long gold;                 // how much gold we have
     unsigned long goldGenerated;        // how much gold has been generated on the levels, not counting gold held by monsters
+    unsigned long itemsFound;           // how many items other than gold we have picked up
     short strength;
     unsigned short monsterSpawnFuse;    // how much longer till a random monster spawns
 
@@ -2566,10 +2600,39 @@ typedef struct playerCharacter {
     char currentGamePath[BROGUE_FILENAME_MAX];
 } playerCharacter;
 
+// What the player remembers of one cell of a stored level.
+typedef struct storedCellMemory {
+    short cell;                                     // x * DROWS + y
+    cellDisplayBuffer appearance;
+    enum itemCategory itemCategory;
+    short itemKind;
+    short itemQuantity;
+    short itemOriginDepth;
+    enum tileType terrain;
+    unsigned long cellFlags;
+    unsigned long terrainFlags;
+    unsigned long TMFlags;
+} storedCellMemory;
+
+// The map of a level the player is not on, kept as one array per field with cells in x * DROWS + y
+// order. Terrain is stored as indices into a palette of the tile types the level uses, and memories
+// only for the cells the player remembers anything about; every other cell has the memory that
+// clearLevel() gives a fresh level.
+typedef struct storedLevelMap {
+    short paletteSize;
+    enum tileType palette[256];
+    unsigned char layers[NUMBER_TERRAIN_LAYERS][DCOLS * DROWS];
+    uint32_t flags[DCOLS * DROWS];                  // PERMANENT_TILE_FLAGS only
+    unsigned short volume[DCOLS * DROWS];
+    unsigned char machineNumber[DCOLS * DROWS];
+    short memoryCount;
+    storedCellMemory memories[];                    // in cell order
+} storedLevelMap;
+
 // Stores the necessary info about a level so it can be regenerated:
 typedef struct levelData {
     boolean visited;
-    pcell mapStorage[DCOLS][DROWS];
+    storedLevelMap *mapStorage;                     // NULL until the player first leaves the level
     struct item *items;
     struct creatureList monsters;
     struct creatureList dormantMonsters;
@@ -2783,6 +2846,20 @@ typedef struct feat {
 #define PDS_OBSTRUCTION -2
 #define PDS_CELL(map, x, y) ((map)->links + ((x) + DCOLS * (y)))
 
+// The terrain flags of every cell, for building whole-map cost maps; see currentTerrain().
+typedef struct terrainSnapshot {
+    enum tileType layers[DCOLS][DROWS][NUMBER_TERRAIN_LAYERS];
+    unsigned long flags[DCOLS][DROWS];              // terrainFlags()
+    unsigned long mechFlags[DCOLS][DROWS];          // terrainMechFlags()
+    unsigned long discoveredFlags[DCOLS][DROWS];    // discoveredTerrainFlagsAtLoc()
+    unsigned long readAt[DCOLS][DROWS];             // when the cell was last read, counting reads; never 0 once read
+} terrainSnapshot;
+
+typedef struct costMapCounters {
+    unsigned long costMaps;                         // whole-map cost maps built
+    unsigned long terrainReads;                     // cells whose terrain flags had to be worked out for them
+} costMapCounters;
+
 #define BUTTON_TEXT_SIZE COLS*3
 typedef struct brogueButton {
     char text[BUTTON_TEXT_SIZE];// button label; can include color escapes
@@ -2856,6 +2933,7 @@ typedef struct archivedMessage {
 
 extern boolean serverMode;
 extern boolean nonInteractivePlayback;
+extern boolean autoplayBatch;
 extern boolean hasGraphics;
 extern enum graphicsModes graphicsMode;
 
@@ -2945,6 +3023,9 @@ extern "C" {
         /// if a mouse move occurs during the pause.
         /// Otherwise, mouse movements will be ignored.
         boolean interuptForMouseMove;
+        /// If `skipScreenUpdate` is true, the pause function only checks for input,
+        /// and neither commits nor presents anything drawn since the last update.
+        boolean skipScreenUpdate;
     } PauseBehavior;
 #define PAUSE_BEHAVIOR_DEFAULT ((PauseBehavior) { .interuptForMouseMove = false })
 
@@ -2962,6 +3043,10 @@ extern "C" {
     void saveResetRun(void);
     rogueRun *loadRunHistory(void);
     fileEntry *listFiles(short *fileCount, char **dynamicMemoryBuffer);
+    void syncFileInBackground(FILE *file);
+    void syncFile(FILE *file);
+    const unsigned char *mapFileForReading(const char *path, size_t *length);
+    void unmapFile(const unsigned char *data, size_t length);
     void initializeLaunchArguments(enum NGCommands *command, char *path, uint64_t *seed);
 
     char nextKeyPress(boolean textInput);
@@ -3058,6 +3143,7 @@ extern "C" {
     boolean placeStairs(pos *upStairsLoc);
     void initializeLevel(pos upStairsLoc);
     void startLevel (short oldLevelNumber, short stairDirection);
+    void clearStoredMonsterFlag(short n, pos loc);
     void updateMinersLightRadius(void);
     void freeCreature(creature *monst);
     void freeCreatureList(creatureList *list);
@@ -3439,6 +3525,8 @@ extern "C" {
     void activateMachine(short machineNumber);
     boolean circuitBreakersPreventActivation(short machineNumber);
     void promoteTile(short x, short y, enum dungeonLayers layer, boolean useFireDF);
+    void markActiveTile(short x, short y);
+    void resetActiveTiles(void);
     void autoPlayLevel(boolean fastForward);
     void updateClairvoyance(void);
     short scentDistance(short x1, short y1, short x2, short y2);
@@ -3447,6 +3535,8 @@ extern "C" {
 
     void initRecording(void);
     void flushBufferToFile(void);
+    void closeRecordingStream(void);
+    void releasePlaybackFile(void);
     void fillBufferFromFile(void);
     void recordEvent(rogueEvent *event);
     void recallEvent(rogueEvent *event);
@@ -3460,6 +3550,9 @@ extern "C" {
     void recordMouseClick(short x, short y, boolean controlKey, boolean shiftKey);
     void OOSCheck(unsigned long x, short numberOfBytes);
     void RNGCheck(void);
+    void stateHashCheck(boolean levelBoundary);
+    void computeStateHashes(uint32_t hashes[NUMBER_OF_STATE_HASH_COMPONENTS]);
+    const char *stateHashComponentName(enum stateHashComponents component);
     boolean executePlaybackInput(rogueEvent *recordingInput);
     void getAvailableFilePath(char *filePath, const char *defaultPath, const char *suffix);
     boolean characterForbiddenInFilename(const char theChar);
@@ -3469,6 +3562,14 @@ extern "C" {
     void saveRecordingNoPrompt(char *filePath);
     void parseFile(void);
     void RNGLog(char *message);
+    boolean playRecordingHeadless(const char *path);
+
+    boolean isPackedRecording(const unsigned char *data, size_t length);
+    unsigned char *unpackRecording(const unsigned char *data, size_t length, size_t *rawLength);
+    void forgetRecordingIndex(void);
+    boolean turnOfArrivalFromIndex(short depth, unsigned long *turnNumber);
+    void noteRecordingPosition(void);
+    int packRecording(const char *inPath, const char *outPath, char *errorMessage);
 
     short wandDominate(creature *monst);
     short staffDamageLow(fixpt enchant);
@@ -3510,6 +3611,11 @@ extern "C" {
     void dialogAlert(char *message);
     void mainBrogueJunction(void);
     int printSeedCatalog(uint64_t startingSeed, uint64_t numberOfSeedsToScan, unsigned int scanThroughDepth, boolean isCsvFormat, char *errorMessage);
+    void printAutoplayCsvHeader(FILE *stream);
+    uint64_t autoplaySeeds(uint64_t firstSeed, uint64_t lastSeed, uint64_t stride, FILE *stream);
+    void noteAutoplayOutcome(const char *outcome, const char *cause);
+    void printVerifyCsvHeader(FILE *stream);
+    boolean verifyRecording(const char *path, FILE *stream);
 
     void initializeButton(brogueButton *button);
     void drawButtonsInState(buttonState *state, screenDisplayBuffer *button_dbuf);
@@ -3532,6 +3638,7 @@ extern "C" {
                           rogueEvent *returnEvent);
 
     void dijkstraScan(short **distanceMap, short **costMap, boolean useDiagonals);
+    const terrainSnapshot *currentTerrain(void);
 
 #if defined __cplusplus
 }
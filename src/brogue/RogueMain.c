@@ -134,6 +134,73 @@ static void screen_update_benchmark() {
 }
 #endif
 
+#ifdef APPEARANCE_BENCHMARK
+static void appearance_benchmark() {
+    const short passes = 200;
+    enum displayGlyph theChar;
+    color foreColor, backColor;
+    screenDisplayBuffer overlay;
+    clock_t startTime;
+    short i, j, k;
+
+    startTime = clock();
+    for (k=0; k<passes; k++) {
+        for (i=0; i<DCOLS; i++) {
+            for (j=0; j<DROWS; j++) {
+                getCellAppearance((pos){ i, j }, &theChar, &foreColor, &backColor);
+            }
+        }
+    }
+    printf("\nDepth %i: full-map appearance pass took %.3f ms.", rogue.depthLevel,
+           1000.0 * (clock() - startTime) / CLOCKS_PER_SEC / passes);
+
+    clearDisplayBuffer(&overlay);
+    for (i=0; i<COLS; i++) {
+        for (j=0; j<ROWS; j++) {
+            overlay.cells[i][j].backColorComponents[2] = 50;
+            overlay.cells[i][j].opacity = 50;
+        }
+    }
+    const SavedDisplayBuffer rbuf = saveDisplayBuffer();
+    startTime = clock();
+    for (k=0; k<passes; k++) {
+        overlayDisplayBuffer(&overlay);
+        restoreDisplayBuffer(&rbuf);
+    }
+    printf("\nDepth %i: full-screen overlay took %.3f ms.\n", rogue.depthLevel,
+           1000.0 * (clock() - startTime) / CLOCKS_PER_SEC / passes);
+    fflush(stdout);
+}
+#endif
+
+#ifdef LINE_OF_FIRE_BENCHMARK
+// Aims at every cell of the level from where the player stands, as moving the targeting cursor
+// around does, and reports how many lines of fire getLineCoordinates() works out per second.
+static void line_of_fire_benchmark() {
+    const short passes = 20;
+    pos listOfCoordinates[MAX_BOLT_LENGTH];
+    unsigned long lines = 0;
+    clock_t startTime;
+    double seconds;
+    short i, j, k;
+
+    startTime = clock();
+    for (k=0; k<passes; k++) {
+        for (i=0; i<DCOLS; i++) {
+            for (j=0; j<DROWS; j++) {
+                getLineCoordinates(listOfCoordinates, player.loc, (pos){ i, j }, &boltCatalog[BOLT_FIRE]);
+                getLineCoordinates(listOfCoordinates, player.loc, (pos){ i, j }, NULL);
+                lines += 2;
+            }
+        }
+    }
+    seconds = (double) (clock() - startTime) / CLOCKS_PER_SEC;
+    printf("\nDepth %i: %lu lines of fire in %.3f s (%.0f lines per second).\n", rogue.depthLevel,
+           lines, seconds, seconds > 0 ? lines / seconds : 0.0);
+    fflush(stdout);
+}
+#endif
+
 static const char *getOrdinalSuffix(int number) {
     // Handle special cases for 11, 12, and 13
     if (number == 11 || number == 12 || number == 13) {
@@ -191,7 +258,7 @@ void initializeRogue(uint64_t seed) {
     short i, j, k;
     item *theItem;
     boolean playingback, playbackFF, playbackPaused, displayStealthRangeMode;
-    boolean trueColorMode;
+    boolean trueColorMode, instantTravel;
     boolean hideSeed;
     short oldRNG;
     char currentGamePath[BROGUE_FILENAME_MAX];
@@ -204,6 +271,7 @@ void initializeRogue(uint64_t seed) {
     hideSeed = rogue.hideSeed;
     displayStealthRangeMode = rogue.displayStealthRangeMode;
     trueColorMode = rogue.trueColorMode;
+    instantTravel = rogue.instantTravel;
 
     strcpy(currentGamePath, rogue.currentGamePath);
 
@@ -219,6 +287,7 @@ void initializeRogue(uint64_t seed) {
     rogue.hideSeed = hideSeed;
     rogue.displayStealthRangeMode = displayStealthRangeMode;
     rogue.trueColorMode = trueColorMode;
+    rogue.instantTravel = instantTravel;
 
     rogue.gameHasEnded = false;
     rogue.gameInProgress = true;
@@ -271,6 +340,7 @@ void initializeRogue(uint64_t seed) {
         levels[i].dormantMonsters = createCreatureList();;
         levels[i].items = NULL;
         levels[i].scentMap = NULL;
+        levels[i].mapStorage = NULL;
         levels[i].visited = false;
         levels[i].playerExitedVia = (pos){ .x = 0, .y = 0 };
         do {
@@ -320,7 +390,7 @@ void initializeRogue(uint64_t seed) {
     for (i = 0; i < MESSAGE_ARCHIVE_ENTRIES; i++) { // Clear the message archive.
         messageArchive[i].message[0] = '\0';
     }
-    messageArchivePosition = 0;
+    clearMessageArchive();
 
     // Seed the stacks.
     floorItems = (item *) malloc(sizeof(item));
@@ -382,6 +452,7 @@ void initializeRogue(uint64_t seed) {
     rogue.foodSpawned = 0;
     rogue.gold = 0;
     rogue.goldGenerated = 0;
+    rogue.itemsFound = 0;
     rogue.disturbed = false;
     rogue.autoPlayingLevel = false;
     rogue.automationActive = false;
@@ -544,12 +615,127 @@ static void updateColors() {
     }
 }
 
+// True if the player remembers something of the cell, i.e. its memory is not what clearLevel() left.
+static boolean cellHasMemories(const pcell *cell) {
+    return ((cell->flags & STABLE_MEMORY)
+            || cell->rememberedTerrain != NOTHING
+            || cell->rememberedTerrainFlags != (T_OBSTRUCTS_EVERYTHING)
+            || cell->rememberedTMFlags
+            || cell->rememberedCellFlags
+            || cell->rememberedItemCategory
+            || cell->rememberedItemKind
+            || cell->rememberedItemQuantity
+            || cell->rememberedItemOriginDepth);
+}
+
+static void storeLevelMap(levelData *level) {
+    short i, j, cell, layer, memoryCount = 0, paletteIndex[NUMBER_TILETYPES];
+    storedLevelMap *map;
+    storedCellMemory *memory;
+
+    for (i=0; i<DCOLS; i++) {
+        for (j=0; j<DROWS; j++) {
+            if (cellHasMemories(&pmap[i][j])) {
+                memoryCount++;
+            }
+        }
+    }
+
+    free(level->mapStorage);
+    map = level->mapStorage = malloc(sizeof(storedLevelMap) + memoryCount * sizeof(storedCellMemory));
+    map->paletteSize = 0;
+    map->memoryCount = memoryCount;
+    for (i = 0; i < NUMBER_TILETYPES; i++) {
+        paletteIndex[i] = -1;
+    }
+
+    memory = map->memories;
+    for (i=0, cell=0; i<DCOLS; i++) {
+        for (j=0; j<DROWS; j++, cell++) {
+            for (layer = 0; layer < NUMBER_TERRAIN_LAYERS; layer++) {
+                const enum tileType tile = pmap[i][j].layers[layer];
+                if (paletteIndex[tile] < 0) {
+                    brogueAssert(map->paletteSize < 256);
+                    paletteIndex[tile] = map->paletteSize;
+                    map->palette[map->paletteSize++] = tile;
+                }
+                map->layers[layer][cell] = (unsigned char) paletteIndex[tile];
+            }
+            map->flags[cell] = (pmap[i][j].flags & PERMANENT_TILE_FLAGS);
+            map->volume[cell] = pmap[i][j].volume;
+            map->machineNumber[cell] = pmap[i][j].machineNumber;
+
+            if (cellHasMemories(&pmap[i][j])) {
+                memory->cell = cell;
+                memory->appearance = pmap[i][j].rememberedAppearance;
+                memory->itemCategory = pmap[i][j].rememberedItemCategory;
+                memory->itemKind = pmap[i][j].rememberedItemKind;
+                memory->itemQuantity = pmap[i][j].rememberedItemQuantity;
+                memory->itemOriginDepth = pmap[i][j].rememberedItemOriginDepth;
+                memory->terrain = pmap[i][j].rememberedTerrain;
+                memory->cellFlags = pmap[i][j].rememberedCellFlags;
+                memory->terrainFlags = pmap[i][j].rememberedTerrainFlags;
+                memory->TMFlags = pmap[i][j].rememberedTMFlags;
+                memory++;
+            }
+        }
+    }
+}
+
+static void restoreLevelMap(const levelData *level) {
+    const storedLevelMap *map = level->mapStorage;
+    const storedCellMemory *memory = map->memories, *lastMemory = map->memories + map->memoryCount;
+    const cellDisplayBuffer noAppearance = {0};
+    short i, j, cell, layer;
+
+    for (i=0, cell=0; i<DCOLS; i++) {
+        for (j=0; j<DROWS; j++, cell++) {
+            for (layer = 0; layer < NUMBER_TERRAIN_LAYERS; layer++) {
+                pmap[i][j].layers[layer] = map->palette[map->layers[layer][cell]];
+            }
+            pmap[i][j].volume = map->volume[cell];
+            pmap[i][j].flags = map->flags[cell];
+            pmap[i][j].machineNumber = map->machineNumber[cell];
+
+            if (memory < lastMemory && memory->cell == cell) {
+                pmap[i][j].rememberedAppearance = memory->appearance;
+                pmap[i][j].rememberedItemCategory = memory->itemCategory;
+                pmap[i][j].rememberedItemKind = memory->itemKind;
+                pmap[i][j].rememberedItemQuantity = memory->itemQuantity;
+                pmap[i][j].rememberedItemOriginDepth = memory->itemOriginDepth;
+                pmap[i][j].rememberedTerrain = memory->terrain;
+                pmap[i][j].rememberedCellFlags = memory->cellFlags;
+                pmap[i][j].rememberedTerrainFlags = memory->terrainFlags;
+                pmap[i][j].rememberedTMFlags = memory->TMFlags;
+                memory++;
+            } else {
+                // Never drawn: its appearance is only read while STABLE_MEMORY is set.
+                pmap[i][j].rememberedAppearance = noAppearance;
+                pmap[i][j].rememberedItemCategory = 0;
+                pmap[i][j].rememberedItemKind = 0;
+                pmap[i][j].rememberedItemQuantity = 0;
+                pmap[i][j].rememberedItemOriginDepth = 0;
+                pmap[i][j].rememberedTerrain = NOTHING;
+                pmap[i][j].rememberedCellFlags = 0;
+                pmap[i][j].rememberedTerrainFlags = (T_OBSTRUCTS_EVERYTHING);
+                pmap[i][j].rememberedTMFlags = 0;
+            }
+        }
+    }
+}
+
+// Called when a monster leaves level n (counting from 0) for the one the player is on.
+void clearStoredMonsterFlag(short n, pos loc) {
+    if (levels[n].mapStorage) {
+        levels[n].mapStorage->flags[loc.x * DROWS + loc.y] &= ~HAS_MONSTER;
+    }
+}
+
 void startLevel(short oldLevelNumber, short stairDirection) {
     uint64_t oldSeed;
     item *theItem;
     short i, j, x, y, px, py, flying, dir;
     boolean placedPlayer;
-    enum dungeonLayers layer;
     unsigned long timeAway;
     short **mapToStairs;
     short **mapToPit;
@@ -642,23 +828,9 @@ void startLevel(short oldLevelNumber, short stairDirection) {
                 // Remember visible cells upon exiting.
                 storeMemories(i, j);
             }
-            for (layer = 0; layer < NUMBER_TERRAIN_LAYERS; layer++) {
-                levels[oldLevelNumber - 1].mapStorage[i][j].layers[layer] = pmap[i][j].layers[layer];
-            }
-            levels[oldLevelNumber - 1].mapStorage[i][j].volume = pmap[i][j].volume;
-            levels[oldLevelNumber - 1].mapStorage[i][j].flags = (pmap[i][j].flags & PERMANENT_TILE_FLAGS);
-            levels[oldLevelNumber - 1].mapStorage[i][j].machineNumber = pmap[i][j].machineNumber;
-            levels[oldLevelNumber - 1].mapStorage[i][j].rememberedAppearance = pmap[i][j].rememberedAppearance;
-            levels[oldLevelNumber - 1].mapStorage[i][j].rememberedItemCategory = pmap[i][j].rememberedItemCategory;
-            levels[oldLevelNumber - 1].mapStorage[i][j].rememberedItemKind = pmap[i][j].rememberedItemKind;
-            levels[oldLevelNumber - 1].mapStorage[i][j].rememberedItemQuantity = pmap[i][j].rememberedItemQuantity;
-            levels[oldLevelNumber - 1].mapStorage[i][j].rememberedItemOriginDepth = pmap[i][j].rememberedItemOriginDepth;
-            levels[oldLevelNumber - 1].mapStorage[i][j].rememberedTerrain = pmap[i][j].rememberedTerrain;
-            levels[oldLevelNumber - 1].mapStorage[i][j].rememberedCellFlags = pmap[i][j].rememberedCellFlags;
-            levels[oldLevelNumber - 1].mapStorage[i][j].rememberedTerrainFlags = pmap[i][j].rememberedTerrainFlags;
-            levels[oldLevelNumber - 1].mapStorage[i][j].rememberedTMFlags = pmap[i][j].rememberedTMFlags;
         }
     }
+    storeLevelMap(&levels[oldLevelNumber - 1]);
 
     levels[oldLevelNumber - 1].awaySince = rogue.absoluteTurnNumber;
 
@@ -748,25 +920,7 @@ void startLevel(short oldLevelNumber, short stairDirection) {
         scentMap = levels[rogue.depthLevel - 1].scentMap;
         timeAway = clamp(0, rogue.absoluteTurnNumber - levels[rogue.depthLevel - 1].awaySince, 30000);
 
-        for (i=0; i<DCOLS; i++) {
-            for (j=0; j<DROWS; j++) {
-                for (layer = 0; layer < NUMBER_TERRAIN_LAYERS; layer++) {
-                    pmap[i][j].layers[layer] = levels[rogue.depthLevel - 1].mapStorage[i][j].layers[layer];
-                }
-                pmap[i][j].volume = levels[rogue.depthLevel - 1].mapStorage[i][j].volume;
-                pmap[i][j].flags = (levels[rogue.depthLevel - 1].mapStorage[i][j].flags & PERMANENT_TILE_FLAGS);
-                pmap[i][j].machineNumber = levels[rogue.depthLevel - 1].mapStorage[i][j].machineNumber;
-                pmap[i][j].rememberedAppearance = levels[rogue.depthLevel - 1].mapStorage[i][j].rememberedAppearance;
-                pmap[i][j].rememberedItemCategory = levels[rogue.depthLevel - 1].mapStorage[i][j].rememberedItemCategory;
-                pmap[i][j].rememberedItemKind = levels[rogue.depthLevel - 1].mapStorage[i][j].rememberedItemKind;
-                pmap[i][j].rememberedItemQuantity = levels[rogue.depthLevel - 1].mapStorage[i][j].rememberedItemQuantity;
-                pmap[i][j].rememberedItemOriginDepth = levels[rogue.depthLevel - 1].mapStorage[i][j].rememberedItemOriginDepth;
-                pmap[i][j].rememberedTerrain = levels[rogue.depthLevel - 1].mapStorage[i][j].rememberedTerrain;
-                pmap[i][j].rememberedCellFlags = levels[rogue.depthLevel - 1].mapStorage[i][j].rememberedCellFlags;
-                pmap[i][j].rememberedTerrainFlags = levels[rogue.depthLevel - 1].mapStorage[i][j].rememberedTerrainFlags;
-                pmap[i][j].rememberedTMFlags = levels[rogue.depthLevel - 1].mapStorage[i][j].rememberedTMFlags;
-            }
-        }
+        restoreLevelMap(&levels[rogue.depthLevel - 1]);
 
         setUpWaypoints();
 
@@ -783,6 +937,8 @@ void startLevel(short oldLevelNumber, short stairDirection) {
 
     }
 
+    resetActiveTiles();
+
     // Simulate the environment!
     // First bury the player in limbo while we run the simulation,
     // so that any harmful terrain doesn't affect her during the process.
@@ -918,10 +1074,18 @@ void startLevel(short oldLevelNumber, short stairDirection) {
     displayLevel();
     refreshSideBar(-1, -1, false);
 
+#ifdef APPEARANCE_BENCHMARK
+    appearance_benchmark();
+#endif
+#ifdef LINE_OF_FIRE_BENCHMARK
+    line_of_fire_benchmark();
+#endif
+
     if (rogue.playerTurnNumber) {
         rogue.playerTurnNumber++; // Increment even though no time has passed.
     }
     RNGCheck();
+    stateHashCheck(true);
     flushBufferToFile();
     deleteAllFlares(); // So discovering something on the same turn that you fall down a level doesn't flash stuff on the previous level.
     hideCursor();
@@ -1008,6 +1172,8 @@ void freeEverything() {
             freeGrid(levels[i].scentMap);
             levels[i].scentMap = NULL;
         }
+        free(levels[i].mapStorage);
+        levels[i].mapStorage = NULL;
     }
     scentMap = NULL;
     freeCreatureList(&purgatory);
@@ -1062,6 +1228,18 @@ void gameOver(char *killedBy, boolean useCustomPhrasing) {
     rogue.gameInProgress = false;
     flushBufferToFile();
 
+    if (autoplayBatch) {
+        if (useCustomPhrasing) {
+            strcpy(buf, killedBy);
+        } else {
+            sprintf(buf, "Killed by a%s %s", (isVowelish(killedBy) ? "n" : ""), killedBy);
+        }
+        noteAutoplayOutcome(rogue.quit ? "quit" : "died", buf);
+        rogue.gameHasEnded = true;
+        rogue.gameExitStatusCode = EXIT_STATUS_SUCCESS;
+        return;
+    }
+
     if (rogue.playbackFastForward) {
         rogue.playbackFastForward = false;
         displayLevel();
@@ -1233,6 +1411,13 @@ void victory(boolean superVictory) {
     rogue.gameInProgress = false;
     flushBufferToFile();
 
+    if (autoplayBatch) {
+        noteAutoplayOutcome(superVictory ? "super victory" : "victory", "");
+        rogue.gameHasEnded = true;
+        rogue.gameExitStatusCode = EXIT_STATUS_SUCCESS;
+        return;
+    }
+
     if (rogue.playbackFastForward) {
         rogue.playbackFastForward = false;
         displayLevel();
@@ -0,0 +1,120 @@
+/*
+ *  StateHashes.c
+ *  Brogue
+ *
+ *  This file is part of Brogue.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Compact fingerprints of the game state, one per component, that a recording can carry so that
+// playback notices the turn on which it diverges and which part of the game went wrong first,
+// rather than waiting for the random number check to fail some time later.
+//
+// Only state that playback reproduces exactly goes into a hash: nothing the display alone touches
+// (remembered appearances, the travel path, dancing colors) and no pointers.
+
+#include "Rogue.h"
+#include "GlobalsBase.h"
+
+#define HASH_OFFSET_BASIS   2166136261u
+#define HASH_PRIME          16777619u
+
+// The invisible bookkeeping that the display sets while it draws.
+#define DISPLAY_ONLY_TILE_FLAGS     (IS_IN_PATH | STABLE_MEMORY | TERRAIN_COLORS_DANCING)
+
+static const char *stateHashComponentNames[NUMBER_OF_STATE_HASH_COMPONENTS] = {
+    "random number count",
+    "player",
+    "monsters",
+    "items",
+    "dungeon",
+};
+
+// FNV-1a over the four bytes of each number, lowest first, so the result is the same everywhere.
+static uint32_t hashNumber(uint32_t hash, unsigned long number) {
+    short i;
+
+    for (i = 0; i < 4; i++) {
+        hash ^= (number >> (8 * i)) & 0xFF;
+        hash *= HASH_PRIME;
+    }
+    return hash;
+}
+
+static uint32_t hashCreature(uint32_t hash, const creature *monst) {
+    hash = hashNumber(hash, monst->info.monsterID);
+    hash = hashNumber(hash, monst->loc.x);
+    hash = hashNumber(hash, monst->loc.y);
+    hash = hashNumber(hash, monst->currentHP);
+    hash = hashNumber(hash, monst->creatureState);
+    hash = hashNumber(hash, monst->ticksUntilTurn);
+    return hash;
+}
+
+static uint32_t hashItems(uint32_t hash, const item *theItem) {
+    for (; theItem != NULL; theItem = theItem->nextItem) {
+        hash = hashNumber(hash, theItem->category);
+        hash = hashNumber(hash, theItem->kind);
+        hash = hashNumber(hash, theItem->quantity);
+        hash = hashNumber(hash, theItem->enchant1);
+        hash = hashNumber(hash, theItem->loc.x);
+        hash = hashNumber(hash, theItem->loc.y);
+        hash = hashNumber(hash, theItem->originDepth);
+    }
+    return hash;
+}
+
+void computeStateHashes(uint32_t hashes[NUMBER_OF_STATE_HASH_COMPONENTS]) {
+    uint32_t hash;
+    short i, j, layer;
+
+    hashes[STATE_HASH_RNG] = hashNumber(HASH_OFFSET_BASIS, randomNumbersGenerated);
+
+    hash = hashCreature(HASH_OFFSET_BASIS, &player);
+    hash = hashNumber(hash, player.status[STATUS_NUTRITION]);
+    hash = hashNumber(hash, rogue.depthLevel);
+    hash = hashNumber(hash, rogue.gold);
+    hash = hashNumber(hash, rogue.strength);
+    hashes[STATE_HASH_PLAYER] = hash;
+
+    hash = HASH_OFFSET_BASIS;
+    for (creatureIterator it = iterateCreatures(monsters); hasNextCreature(it);) {
+        hash = hashCreature(hash, nextCreature(&it));
+    }
+    for (creatureIterator it = iterateCreatures(dormantMonsters); hasNextCreature(it);) {
+        hash = hashCreature(hash, nextCreature(&it));
+    }
+    hashes[STATE_HASH_MONSTERS] = hash;
+
+    hash = hashItems(HASH_OFFSET_BASIS, floorItems->nextItem);
+    hashes[STATE_HASH_ITEMS] = hashItems(hash, packItems->nextItem);
+
+    hash = HASH_OFFSET_BASIS;
+    for (i = 0; i < DCOLS; i++) {
+        for (j = 0; j < DROWS; j++) {
+            for (layer = 0; layer < NUMBER_TERRAIN_LAYERS; layer++) {
+                hash = hashNumber(hash, pmap[i][j].layers[layer]);
+            }
+            hash = hashNumber(hash, pmap[i][j].flags & ~DISPLAY_ONLY_TILE_FLAGS);
+            hash = hashNumber(hash, pmap[i][j].volume);
+            hash = hashNumber(hash, pmap[i][j].machineNumber);
+        }
+    }
+    hashes[STATE_HASH_DUNGEON] = hash;
+}
+
+const char *stateHashComponentName(enum stateHashComponents component) {
+    return stateHashComponentNames[component];
+}
@@ -646,22 +646,50 @@ short scentDistance(short x1, short y1, short x2, short y2) {
     }
 }
 
+// scentDistance() from the middle cell, so that any offset from the player within the map is in range:
+// the distance from the player to (x, y) is scentKernel[x - player.x + DCOLS - 1][y - player.y + DROWS - 1].
+static unsigned short scentKernel[2 * DCOLS - 1][2 * DROWS - 1];
+static boolean scentKernelReady = false;
+
+// Lays the same scent as calling addScentToCell() on every cell the player's scent can reach, with
+// the scent distance from the player, but a column at a time so the compiler can vectorize the max.
 static void updateScent() {
     short i, j;
     char grid[DCOLS][DROWS];
+    unsigned short value, *scentColumn;
+    const unsigned short *distanceColumn;
+
+    if (!scentKernelReady) {
+        for (i = 0; i < 2 * DCOLS - 1; i++) {
+            for (j = 0; j < 2 * DROWS - 1; j++) {
+                scentKernel[i][j] = scentDistance(i, j, DCOLS - 1, DROWS - 1);
+            }
+        }
+        scentKernelReady = true;
+    }
 
     zeroOutGrid(grid);
 
     getFOVMask(grid, player.loc.x, player.loc.y, DCOLS * FP_FACTOR, T_OBSTRUCTS_SCENT, 0, false);
+    grid[player.loc.x][player.loc.y] = true;
 
     for (i=0; i<DCOLS; i++) {
+        // addScentToCell() skips cells that obstruct both scent and passability, which are just the
+        // ones that obstruct passability.
         for (j=0; j<DROWS; j++) {
-            if (grid[i][j]) {
-                addScentToCell(i, j, scentDistance(player.loc.x, player.loc.y, i, j));
+            if (grid[i][j] && (terrainFlags((pos){ i, j }) & T_OBSTRUCTS_PASSABILITY)) {
+                grid[i][j] = false;
+            }
+        }
+        scentColumn = (unsigned short *) scentMap[i];
+        distanceColumn = &scentKernel[i - player.loc.x + DCOLS - 1][DROWS - 1 - player.loc.y];
+        for (j=0; j<DROWS; j++) {
+            value = rogue.scentTurnNumber - distanceColumn[j];
+            if (grid[i][j] && value > scentColumn[j]) {
+                scentColumn[j] = value;
             }
         }
     }
-    addScentToCell(player.loc.x, player.loc.y, 0);
 }
 
 short armorStealthAdjustment(item *theArmor) {
@@ -1098,6 +1126,54 @@ boolean circuitBreakersPreventActivation(short machineNumber) {
     return false;
 }
 
+// Cells with terrain that acts by itself every turn: it can promote by chance, it is burning, or it
+// promotes when no key is on it. Only these can do anything in the promotion, key and fire passes of
+// updateEnvironment(), so those passes skip every other cell, keeping the column-by-column order of
+// a scan of the whole map. Terrain is added by markActiveTile() wherever it is placed during play,
+// and the set is rebuilt from scratch by resetActiveTiles() when a level is entered. A cell whose
+// active terrain has gone is dropped the next time the promotion pass finds it.
+static boolean activeTiles[DCOLS][DROWS];
+static short activeTileCount[DCOLS];
+
+// Cells whose exposedToFire count is not zero, so that it can be reset without touching the rest.
+static pos exposedTiles[DCOLS * DROWS];
+static short exposedTileCount = 0;
+
+static boolean cellIsActive(short x, short y) {
+    enum dungeonLayers layer;
+    const floorTileType *tile;
+
+    for (layer = 0; layer < NUMBER_TERRAIN_LAYERS; layer++) {
+        tile = &tileCatalog[pmap[x][y].layers[layer]];
+        if (tile->promoteChance
+            || (tile->flags & T_IS_FIRE)
+            || (tile->mechFlags & TM_PROMOTES_WITHOUT_KEY)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Call after placing terrain at (x, y) during play.
+void markActiveTile(short x, short y) {
+    if (!activeTiles[x][y] && cellIsActive(x, y)) {
+        activeTiles[x][y] = true;
+        activeTileCount[x]++;
+    }
+}
+
+void resetActiveTiles() {
+    short i, j;
+
+    for (i=0; i<DCOLS; i++) {
+        activeTileCount[i] = 0;
+        for (j=0; j<DROWS; j++) {
+            activeTiles[i][j] = false;
+            markActiveTile(i, j);
+        }
+    }
+}
+
 void promoteTile(short x, short y, enum dungeonLayers layer, boolean useFireDF) {
     short i, j;
     enum dungeonFeatureTypes DFType;
@@ -1166,7 +1242,9 @@ boolean exposeTileToFire(short x, short y, boolean alwaysIgnite) {
         return false;
     }
 
-    pmap[x][y].exposedToFire++;
+    if (pmap[x][y].exposedToFire++ == 0) {
+        exposedTiles[exposedTileCount++] = (pos){ x, y };
+    }
 
     // Pick the extinguishing layer with the best priority.
     for (layer=0; layer < NUMBER_TERRAIN_LAYERS; layer++) {
@@ -1220,7 +1298,41 @@ boolean exposeTileToFire(short x, short y, boolean alwaysIgnite) {
     return fireIgnited;
 }
 
-// Only the gas layer can be volumetric.
+// Which cells gas can flow through, and how many ways gas can leave each of those: to itself, to
+// each neighbor that holds gas and, from a chasm, out of the level. No tile in the gas layer
+// obstructs gas or descends, so this holds for both steps of a turn's update.
+static boolean holdsGas[DCOLS][DROWS];
+static short gasSpaces[DCOLS][DROWS];
+
+static void prepareGasFlow() {
+    short i, j, newX, newY;
+    unsigned long flags;
+    enum directions dir;
+
+    for (i=0; i<DCOLS; i++) {
+        for (j=0; j<DROWS; j++) {
+            flags = terrainFlags((pos){ i, j });
+            holdsGas[i][j] = !(flags & T_OBSTRUCTS_GAS);
+            gasSpaces[i][j] = 1;
+            if (flags & T_AUTO_DESCENT) { // if it's a chasm tile or trap door,
+                gasSpaces[i][j]++; // this will allow gas to escape from the level entirely
+            }
+        }
+    }
+    for (i=0; i<DCOLS; i++) {
+        for (j=0; j<DROWS; j++) {
+            for (dir=0; dir< DIRECTION_COUNT; dir++) {
+                newX = i + nbDirs[dir][0];
+                newY = j + nbDirs[dir][1];
+                if (coordinatesAreInMap(newX, newY) && holdsGas[newX][newY]) {
+                    gasSpaces[i][j]++;
+                }
+            }
+        }
+    }
+}
+
+// Only the gas layer can be volumetric. Call prepareGasFlow() first.
 static void updateVolumetricMedia() {
     short i, j, newX, newY, numSpaces;
     unsigned long highestNeighborVolume;
@@ -1228,37 +1340,53 @@ static void updateVolumetricMedia() {
     enum tileType gasType;
     enum directions dir;
     unsigned short newGasVolume[DCOLS][DROWS];
+    boolean gasNearby[DCOLS][DROWS];
 
     for (i=0; i<DCOLS; i++) {
         for (j=0; j<DROWS; j++) {
             newGasVolume[i][j] = 0;
+            gasNearby[i][j] = false;
+        }
+    }
+    for (i=0; i<DCOLS; i++) {
+        for (j=0; j<DROWS; j++) {
+            if (pmap[i][j].volume) {
+                for (newX = max(0, i - 1); newX <= min(DCOLS - 1, i + 1); newX++) {
+                    for (newY = max(0, j - 1); newY <= min(DROWS - 1, j + 1); newY++) {
+                        gasNearby[newX][newY] = true;
+                    }
+                }
+            }
         }
     }
 
     for (i=0; i<DCOLS; i++) {
         for (j=0; j<DROWS; j++) {
-            if (!cellHasTerrainFlag((pos){ i, j }, T_OBSTRUCTS_GAS)) {
+            if (holdsGas[i][j] && !gasNearby[i][j]) {
+                // Nothing to spread or dissipate; just take the rounding draw and clear any stale gas.
+                rand_range(0, gasSpaces[i][j] - 1);
+                if (pmap[i][j].layers[GAS]) {
+                    pmap[i][j].layers[GAS] = NOTHING;
+                    refreshDungeonCell((pos){ i, j });
+                }
+            } else if (holdsGas[i][j]) {
                 sum = pmap[i][j].volume;
-                numSpaces = 1;
+                numSpaces = gasSpaces[i][j];
                 highestNeighborVolume = pmap[i][j].volume;
                 gasType = pmap[i][j].layers[GAS];
                 for (dir=0; dir< DIRECTION_COUNT; dir++) {
                     newX = i + nbDirs[dir][0];
                     newY = j + nbDirs[dir][1];
                     if (coordinatesAreInMap(newX, newY)
-                        && !cellHasTerrainFlag((pos){ newX, newY }, T_OBSTRUCTS_GAS)) {
+                        && holdsGas[newX][newY]) {
 
                         sum += pmap[newX][newY].volume;
-                        numSpaces++;
                         if (pmap[newX][newY].volume > highestNeighborVolume) {
                             highestNeighborVolume = pmap[newX][newY].volume;
                             gasType = pmap[newX][newY].layers[GAS];
                         }
                     }
                 }
-                if (cellHasTerrainFlag((pos){ i, j }, T_AUTO_DESCENT)) { // if it's a chasm tile or trap door,
-                    numSpaces++; // this will allow gas to escape from the level entirely
-                }
                 newGasVolume[i][j] += sum / max(1, numSpaces);
                 if ((unsigned) rand_range(0, numSpaces - 1) < (sum % numSpaces)) {
                     newGasVolume[i][j]++; // stochastic rounding
@@ -1268,6 +1396,7 @@ static void updateVolumetricMedia() {
                         newGasVolume[i][j] = min(3, newGasVolume[i][j]); // otherwise interactions between gases are crazy
                     }
                     pmap[i][j].layers[GAS] = gasType;
+                    markActiveTile(i, j);
                 } else if (pmap[i][j].layers[GAS] && newGasVolume[i][j] < 1) {
                     pmap[i][j].layers[GAS] = NOTHING;
                     refreshDungeonCell((pos){ i, j });
@@ -1286,7 +1415,7 @@ static void updateVolumetricMedia() {
                     newX = i + nbDirs[dir][0];
                     newY = j + nbDirs[dir][1];
                     if (coordinatesAreInMap(newX, newY)
-                        && !cellHasTerrainFlag((pos){ newX, newY }, T_OBSTRUCTS_GAS)) {
+                        && holdsGas[newX][newY]) {
 
                         numSpaces++;
                     }
@@ -1296,11 +1425,12 @@ static void updateVolumetricMedia() {
                         newX = i + nbDirs[dir][0];
                         newY = j + nbDirs[dir][1];
                         if (coordinatesAreInMap(newX, newY)
-                            && !cellHasTerrainFlag((pos){ newX, newY }, T_OBSTRUCTS_GAS)) {
+                            && holdsGas[newX][newY]) {
 
                             newGasVolume[newX][newY] += (pmap[i][j].volume / numSpaces);
                             if (pmap[i][j].volume / numSpaces) {
                                 pmap[newX][newY].layers[GAS] = pmap[i][j].layers[GAS];
+                                markActiveTile(newX, newY);
                             }
                         }
                     }
@@ -1331,7 +1461,7 @@ static void updateYendorWardenTracking() {
         return;
     }
     if (!(rogue.yendorWarden->bookkeepingFlags & MB_PREPLACED)) {
-        levels[rogue.yendorWarden->depth - 1].mapStorage[rogue.yendorWarden->loc.x][rogue.yendorWarden->loc.y].flags &= ~HAS_MONSTER;
+        clearStoredMonsterFlag(rogue.yendorWarden->depth - 1, rogue.yendorWarden->loc);
     }
     n = rogue.yendorWarden->depth - 1;
 
@@ -1410,7 +1540,9 @@ void monstersFall() {
 }
 
 void updateEnvironment() {
-    short i, j, direction, newX, newY, promotions[DCOLS][DROWS];
+    short i, j, k, direction, newX, newY, promotedCount;
+    unsigned char promotions[DCOLS * DROWS];
+    pos promotedTiles[DCOLS * DROWS];
     long promoteChance;
     enum dungeonLayers layer;
     const floorTileType *tile;
@@ -1419,11 +1551,10 @@ void updateEnvironment() {
     monstersFall();
 
     // reset exposedToFire
-    for (i=0; i<DCOLS; i++) {
-        for (j=0; j<DROWS; j++) {
-            pmap[i][j].exposedToFire = 0;
-        }
+    for (k = 0; k < exposedTileCount; k++) {
+        pmapAt(exposedTiles[k])->exposedToFire = 0;
     }
+    exposedTileCount = 0;
 
     // update gases twice
     for (i=0; i<DCOLS && !isVolumetricGas; i++) {
@@ -1434,15 +1565,31 @@ void updateEnvironment() {
         }
     }
     if (isVolumetricGas) {
+        prepareGasFlow();
         updateVolumetricMedia();
         updateVolumetricMedia();
     }
 
+#ifdef BROGUE_ASSERTS
+    for (i=0; i<DCOLS; i++) {
+        for (j=0; j<DROWS; j++) {
+            brogueAssert(activeTiles[i][j] || !cellIsActive(i, j));
+        }
+    }
+#endif
+
     // Do random tile promotions in two passes to keep generations distinct.
     // First pass, make a note of each terrain layer at each coordinate that is going to promote:
+    promotedCount = 0;
     for (i=0; i<DCOLS; i++) {
+        if (!activeTileCount[i]) {
+            continue;
+        }
         for (j=0; j<DROWS; j++) {
-            promotions[i][j] = 0;
+            if (!activeTiles[i][j]) {
+                continue;
+            }
+            promotions[promotedCount] = 0;
             for (layer = 0; layer < NUMBER_TERRAIN_LAYERS; layer++) {
                 tile = &(tileCatalog[pmap[i][j].layers[layer]]);
                 if (tile->promoteChance < 0) {
@@ -1461,21 +1608,25 @@ void updateEnvironment() {
                 if (promoteChance
                     && !(pmap[i][j].flags & CAUGHT_FIRE_THIS_TURN)
                     && rand_range(0, 10000) < promoteChance) {
-                    promotions[i][j] |= Fl(layer);
+                    promotions[promotedCount] |= Fl(layer);
                     //promoteTile(i, j, layer, false);
                 }
             }
+            if (promotions[promotedCount]) {
+                promotedTiles[promotedCount++] = (pos){ i, j };
+            } else if (!cellIsActive(i, j)) {
+                activeTiles[i][j] = false;
+                activeTileCount[i]--;
+            }
         }
     }
     // Second pass, do the promotions:
-    for (i=0; i<DCOLS; i++) {
-        for (j=0; j<DROWS; j++) {
-            for (layer = 0; layer < NUMBER_TERRAIN_LAYERS; layer++) {
-                if ((promotions[i][j] & Fl(layer))) {
-                    //&& (tileCatalog[pmap[i][j].layers[layer]].promoteChance != 0)){
-                    // make sure that it's still a promotable layer
-                    promoteTile(i, j, layer, false);
-                }
+    for (k = 0; k < promotedCount; k++) {
+        for (layer = 0; layer < NUMBER_TERRAIN_LAYERS; layer++) {
+            if ((promotions[k] & Fl(layer))) {
+                //&& (tileCatalog[pmap[i][j].layers[layer]].promoteChance != 0)){
+                // make sure that it's still a promotable layer
+                promoteTile(promotedTiles[k].x, promotedTiles[k].y, layer, false);
             }
         }
     }
@@ -1489,7 +1640,8 @@ void updateEnvironment() {
 
                 pmap[i][j].flags &= ~PRESSURE_PLATE_DEPRESSED;
             }
-            if (cellHasTMFlag((pos){ i, j }, TM_PROMOTES_WITHOUT_KEY) && !keyOnTileAt((pos){ i, j })) {
+            if (activeTiles[i][j]
+                && cellHasTMFlag((pos){ i, j }, TM_PROMOTES_WITHOUT_KEY) && !keyOnTileAt((pos){ i, j })) {
                 for (layer = 0; layer < NUMBER_TERRAIN_LAYERS; layer++) {
                     if (tileCatalog[pmap[i][j].layers[layer]].mechFlags & TM_PROMOTES_WITHOUT_KEY) {
                         promoteTile(i, j, layer, false);
@@ -1502,7 +1654,8 @@ void updateEnvironment() {
     // Update fire.
     for (i=0; i<DCOLS; i++) {
         for (j=0; j<DROWS; j++) {
-            if (cellHasTerrainFlag((pos){ i, j }, T_IS_FIRE) && !(pmap[i][j].flags & CAUGHT_FIRE_THIS_TURN)) {
+            if (activeTiles[i][j]
+                && cellHasTerrainFlag((pos){ i, j }, T_IS_FIRE) && !(pmap[i][j].flags & CAUGHT_FIRE_THIS_TURN)) {
                 exposeTileToFire(i, j, false);
                 for (direction=0; direction<4; direction++) {
                     newX = i + nbDirs[direction][0];
@@ -1522,6 +1675,7 @@ void updateEnvironment() {
 void updateAllySafetyMap() {
     short i, j;
     short **playerCostMap, **monsterCostMap;
+    const terrainSnapshot *terrain = currentTerrain();
 
     rogue.updatedAllySafetyMapThisTurn = true;
 
@@ -1534,13 +1688,13 @@ void updateAllySafetyMap() {
 
             playerCostMap[i][j] = monsterCostMap[i][j] = 1;
 
-            if (cellHasTerrainFlag((pos){ i, j }, T_OBSTRUCTS_PASSABILITY)
-                && (!cellHasTMFlag((pos){ i, j }, TM_IS_SECRET) || (discoveredTerrainFlagsAtLoc((pos){ i, j }) & T_OBSTRUCTS_PASSABILITY))) {
+            if ((terrain->flags[i][j] & T_OBSTRUCTS_PASSABILITY)
+                && (!(terrain->mechFlags[i][j] & TM_IS_SECRET) || (terrain->discoveredFlags[i][j] & T_OBSTRUCTS_PASSABILITY))) {
 
-                playerCostMap[i][j] = monsterCostMap[i][j] = cellHasTerrainFlag((pos){ i, j }, T_OBSTRUCTS_DIAGONAL_MOVEMENT) ? PDS_OBSTRUCTION : PDS_FORBIDDEN;
-            } else if (cellHasTerrainFlag((pos){ i, j }, T_PATHING_BLOCKER & ~T_OBSTRUCTS_PASSABILITY)) {
+                playerCostMap[i][j] = monsterCostMap[i][j] = (terrain->flags[i][j] & T_OBSTRUCTS_DIAGONAL_MOVEMENT) ? PDS_OBSTRUCTION : PDS_FORBIDDEN;
+            } else if (terrain->flags[i][j] & T_PATHING_BLOCKER & ~T_OBSTRUCTS_PASSABILITY) {
                 playerCostMap[i][j] = monsterCostMap[i][j] = PDS_FORBIDDEN;
-            } else if (cellHasTerrainFlag((pos){ i, j }, T_SACRED)) {
+            } else if (terrain->flags[i][j] & T_SACRED) {
                 playerCostMap[i][j] = 1;
                 monsterCostMap[i][j] = PDS_FORBIDDEN;
             } else if ((pmap[i][j].flags & HAS_MONSTER) && monstersAreEnemies(&player, monsterAtLoc((pos){ i, j }))) {
@@ -1598,6 +1752,7 @@ static void resetDistanceCellInGrid(short **grid, short x, short y) {
 void updateSafetyMap() {
     short i, j;
     short **playerCostMap, **monsterCostMap;
+    const terrainSnapshot *terrain = currentTerrain();
     creature *monst;
 
     rogue.updatedSafetyMapThisTurn = true;
@@ -1611,14 +1766,14 @@ void updateSafetyMap() {
 
             playerCostMap[i][j] = monsterCostMap[i][j] = 1; // prophylactic
 
-            if (cellHasTerrainFlag((pos){ i, j }, T_OBSTRUCTS_PASSABILITY)
-                && (!cellHasTMFlag((pos){ i, j }, TM_IS_SECRET) || (discoveredTerrainFlagsAtLoc((pos){ i, j }) & T_OBSTRUCTS_PASSABILITY))) {
+            if ((terrain->flags[i][j] & T_OBSTRUCTS_PASSABILITY)
+                && (!(terrain->mechFlags[i][j] & TM_IS_SECRET) || (terrain->discoveredFlags[i][j] & T_OBSTRUCTS_PASSABILITY))) {
 
-                playerCostMap[i][j] = monsterCostMap[i][j] = cellHasTerrainFlag((pos){ i, j }, T_OBSTRUCTS_DIAGONAL_MOVEMENT) ? PDS_OBSTRUCTION : PDS_FORBIDDEN;
-            } else if (cellHasTerrainFlag((pos){ i, j }, T_SACRED)) {
+                playerCostMap[i][j] = monsterCostMap[i][j] = (terrain->flags[i][j] & T_OBSTRUCTS_DIAGONAL_MOVEMENT) ? PDS_OBSTRUCTION : PDS_FORBIDDEN;
+            } else if (terrain->flags[i][j] & T_SACRED) {
                 playerCostMap[i][j] = 1;
                 monsterCostMap[i][j] = PDS_FORBIDDEN;
-            } else if (cellHasTerrainFlag((pos){ i, j }, T_LAVA_INSTA_DEATH)) {
+            } else if (terrain->flags[i][j] & T_LAVA_INSTA_DEATH) {
                 monsterCostMap[i][j] = PDS_FORBIDDEN;
                 if (player.status[STATUS_LEVITATING] || !player.status[STATUS_IMMUNE_TO_FIRE]) {
                     playerCostMap[i][j] = 1;
@@ -1640,29 +1795,29 @@ void updateSafetyMap() {
                     }
                 }
 
-                if (cellHasTerrainFlag((pos){ i, j }, (T_AUTO_DESCENT | T_IS_DF_TRAP))) {
+                if (terrain->flags[i][j] & (T_AUTO_DESCENT | T_IS_DF_TRAP)) {
                     monsterCostMap[i][j] = PDS_FORBIDDEN;
                     if (player.status[STATUS_LEVITATING]) {
                         playerCostMap[i][j] = 1;
                     } else {
                         playerCostMap[i][j] = PDS_FORBIDDEN;
                     }
-                } else if (cellHasTerrainFlag((pos){ i, j }, T_IS_FIRE)) {
+                } else if (terrain->flags[i][j] & T_IS_FIRE) {
                     monsterCostMap[i][j] = PDS_FORBIDDEN;
                     if (player.status[STATUS_IMMUNE_TO_FIRE]) {
                         playerCostMap[i][j] = 1;
                     } else {
                         playerCostMap[i][j] = PDS_FORBIDDEN;
                     }
-                } else if (cellHasTerrainFlag((pos){ i, j }, (T_IS_DEEP_WATER | T_SPONTANEOUSLY_IGNITES))) {
+                } else if (terrain->flags[i][j] & (T_IS_DEEP_WATER | T_SPONTANEOUSLY_IGNITES)) {
                     if (player.status[STATUS_LEVITATING]) {
                         playerCostMap[i][j] = 1;
                     } else {
                         playerCostMap[i][j] = 5;
                     }
                     monsterCostMap[i][j] = 5;
-                } else if (cellHasTerrainFlag((pos){ i, j }, T_OBSTRUCTS_PASSABILITY)
-                           && cellHasTMFlag((pos){ i, j }, TM_IS_SECRET) && !(discoveredTerrainFlagsAtLoc((pos){ i, j }) & T_OBSTRUCTS_PASSABILITY)
+                } else if ((terrain->flags[i][j] & T_OBSTRUCTS_PASSABILITY)
+                           && (terrain->mechFlags[i][j] & TM_IS_SECRET) && !(terrain->discoveredFlags[i][j] & T_OBSTRUCTS_PASSABILITY)
                            && !(pmap[i][j].flags & IN_FIELD_OF_VIEW)) {
                     // Secret door that the player can't currently see
                     playerCostMap[i][j] = 100;
@@ -1872,7 +2027,7 @@ static void monsterEntersLevel(creature *monst, short n) {
     char monstName[COLS], buf[COLS];
     boolean pit = false;
 
-    levels[n].mapStorage[monst->loc.x][monst->loc.y].flags &= ~HAS_MONSTER;
+    clearStoredMonsterFlag(n, monst->loc);
 
     // place traversing monster near the stairs on this level
     if (monst->bookkeepingFlags & MB_APPROACHING_DOWNSTAIRS) {
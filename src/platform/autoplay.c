@@ -0,0 +1,330 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include "platform.h"
+#include "GlobalsBase.h"
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Headless driver for --autoplay. Games are split across worker processes by seed (worker k plays
+// first + k, first + k + jobs, ...) and their CSV lines are merged back in seed order, so the
+// output does not depend on the number of jobs. --verify-recordings replays each recording in a
+// process of its own, so that one that crashes cannot take any others down with it.
+
+static boolean autoplay_pauseForMilliseconds(short milliseconds, PauseBehavior behavior) {
+    return false;
+}
+
+static void autoplay_nextKeyOrMouseEvent(rogueEvent *returnEvent, boolean textInput, boolean colorsDance) {
+    // Nobody is at the keyboard; anything that insists on waiting for a key gets escape.
+    returnEvent->eventType = KEYSTROKE;
+    returnEvent->param1 = ESCAPE_KEY;
+    returnEvent->param2 = 0;
+    returnEvent->controlKey = false;
+    returnEvent->shiftKey = false;
+}
+
+static void autoplay_plotChar(enum displayGlyph ch,
+              short xLoc, short yLoc,
+              short foreRed, short foreGreen, short foreBlue,
+              short backRed, short backGreen, short backBlue) {
+    return;
+}
+
+static boolean autoplay_modifierHeld(int modifier) {
+    return false;
+}
+
+static struct brogueConsole autoplayConsole = {
+    NULL,
+    autoplay_pauseForMilliseconds,
+    autoplay_nextKeyOrMouseEvent,
+    autoplay_plotChar,
+    NULL,
+    autoplay_modifierHeld,
+    NULL,
+    NULL,
+    NULL
+};
+
+static double secondsSince(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) (now.tv_sec - start->tv_sec) + (double) (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+#ifndef _WIN32
+// Copies the workers' output to stdout one line at a time, taking the workers in turn, which
+// puts the lines back into seed order. A worker that died early is reported for each missing seed.
+static void mergeWorkerOutput(FILE **parts, int jobs, uint64_t firstSeed, uint64_t lastSeed) {
+    char line[4 * COLS];
+    uint64_t seed;
+    int k;
+
+    for (k = 0; k < jobs; k++) {
+        rewind(parts[k]);
+    }
+    for (seed = firstSeed, k = 0; seed <= lastSeed && seed >= firstSeed; seed++, k = (k + 1) % jobs) {
+        if (fgets(line, sizeof(line), parts[k])) {
+            fputs(line, stdout);
+        } else {
+            printf("%s,%llu,error,\"worker process failed\",0,0,0,0,0\n",
+                   gameConst->variantName, (unsigned long long) seed);
+        }
+    }
+    fflush(stdout);
+}
+#endif
+
+// Plays every seed from firstSeed to lastSeed without a display and prints one CSV line per game.
+// Returns the process exit code.
+int runAutoplayBatch(uint64_t firstSeed, uint64_t lastSeed, int jobs) {
+    struct timespec start;
+    uint64_t games = 0;
+    double seconds;
+
+    currentConsole = autoplayConsole;
+    autoplayBatch = true;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    printAutoplayCsvHeader(stdout);
+    fflush(stdout);
+
+#ifdef _WIN32
+    jobs = 1; // no fork(); play everything in this process
+#endif
+    if (lastSeed - firstSeed + 1 < (uint64_t) jobs) {
+        jobs = (int) (lastSeed - firstSeed + 1);
+    }
+
+    if (jobs <= 1) {
+        games = autoplaySeeds(firstSeed, lastSeed, 1, stdout);
+    } else {
+#ifndef _WIN32
+        FILE **parts = calloc(jobs, sizeof(FILE *));
+        pid_t *workers = calloc(jobs, sizeof(pid_t));
+        int k, started;
+
+        for (k = 0; k < jobs; k++) {
+            parts[k] = tmpfile();
+            if (!parts[k]) {
+                fprintf(stderr, "Could not create a temporary file for autoplay worker %i\n", k + 1);
+                break; // don't start any more, but still wait for the ones already running
+            }
+            workers[k] = fork();
+            if (workers[k] == 0) {
+                autoplaySeeds(firstSeed + k, lastSeed, jobs, parts[k]);
+                fflush(parts[k]);
+                _exit(0);
+            } else if (workers[k] < 0) {
+                fprintf(stderr, "Could not start autoplay worker %i\n", k + 1);
+            }
+        }
+        started = k;
+        for (k = 0; k < started; k++) {
+            if (workers[k] > 0) {
+                waitpid(workers[k], NULL, 0);
+            }
+        }
+        if (started == jobs) {
+            initializeGameVariant(); // for the variant name in any error lines
+            mergeWorkerOutput(parts, jobs, firstSeed, lastSeed);
+            games = lastSeed - firstSeed + 1;
+        }
+        for (k = 0; k < started; k++) {
+            fclose(parts[k]);
+        }
+        free(parts);
+        free(workers);
+        if (started < jobs) {
+            return 1;
+        }
+#endif
+    }
+
+    seconds = secondsSince(&start);
+    fprintf(stderr, "Played %llu games in %.1f seconds (%.0f games per hour)\n",
+            (unsigned long long) games, seconds, seconds > 0 ? games * 3600.0 / seconds : 0.0);
+    return 0;
+}
+
+static int compareNames(const void *a, const void *b) {
+    return strcmp(*(char *const *) a, *(char *const *) b);
+}
+
+// Lists the recordings and saved games in directory, sorted by name. Returns NULL if the directory
+// cannot be read.
+static char **listRecordings(const char *directory, int *count) {
+    DIR *dp = opendir(directory);
+    struct dirent *ep;
+    char **paths = NULL, **morePaths;
+    int capacity = 0;
+    size_t length;
+
+    *count = 0;
+    if (!dp) {
+        return NULL;
+    }
+    while ((ep = readdir(dp))) {
+        if (!endswith(ep->d_name, RECORDING_SUFFIX) && !endswith(ep->d_name, GAME_SUFFIX)) {
+            continue;
+        }
+        if (*count == capacity) {
+            capacity = max(64, capacity * 2);
+            morePaths = realloc(paths, capacity * sizeof(char *));
+            if (!morePaths) {
+                break;
+            }
+            paths = morePaths;
+        }
+        length = strlen(directory) + strlen(ep->d_name) + 2;
+        paths[*count] = malloc(length);
+        snprintf(paths[*count], length, "%s%s%s", directory, endswith(directory, "/") ? "" : "/", ep->d_name);
+        (*count)++;
+    }
+    closedir(dp);
+
+    if (*count) {
+        qsort(paths, *count, sizeof(char *), compareNames);
+    }
+    return (paths ? paths : calloc(1, sizeof(char *)));
+}
+
+#ifdef _WIN32
+// Verifies every recording in this process, and returns how many failed.
+static int verifyRecordings(char **paths, int count) {
+    int i, failures = 0;
+
+    for (i = 0; i < count; i++) {
+        if (!verifyRecording(paths[i], stdout)) {
+            failures++;
+        }
+    }
+    return failures;
+}
+#else
+typedef struct verifier {
+    pid_t pid;      // 0 when the slot is free
+    int index;      // of the recording it replays
+    FILE *output;   // where it writes its CSV line
+} verifier;
+
+// Collects the CSV line of a finished verifier, or a failure line if it died without writing one.
+static char *verifierResult(verifier *v, char **paths) {
+    char line[4 * BROGUE_FILENAME_MAX];
+
+    if (v->output) {
+        rewind(v->output);
+    }
+    if (!v->output || !fgets(line, sizeof(line), v->output)) {
+        snprintf(line, sizeof(line), "\"%s\",failed,error,\"replay process failed\",0,0,0,0,,0,0\n",
+                 paths[v->index]);
+    }
+    if (v->output) {
+        fclose(v->output);
+    }
+    v->pid = 0;
+    v->output = NULL;
+    return strdup(line);
+}
+
+// Replays each recording in a process of its own, up to jobs at a time, so that one that crashes
+// the game only fails itself. Prints the CSV lines in the order of paths, and returns how many of
+// the recordings failed.
+static int verifyRecordings(char **paths, int count, int jobs) {
+    verifier *verifiers = calloc(jobs, sizeof(verifier));
+    char **lines = calloc(max(1, count), sizeof(char *));
+    int next = 0, printed = 0, failures = 0, k;
+    pid_t pid;
+
+    while (printed < count) {
+        for (k = 0; k < jobs && next < count; k++) {
+            if (verifiers[k].pid) {
+                continue;
+            }
+            verifiers[k].index = next++;
+            verifiers[k].output = tmpfile();
+            fflush(stdout); // or the child would inherit our unwritten output
+            pid = (verifiers[k].output ? fork() : -1);
+            if (pid == 0) {
+                verifyRecording(paths[verifiers[k].index], verifiers[k].output);
+                fflush(verifiers[k].output);
+                _exit(0);
+            } else if (pid < 0) {
+                lines[verifiers[k].index] = verifierResult(&verifiers[k], paths);
+            } else {
+                verifiers[k].pid = pid;
+            }
+        }
+
+        pid = waitpid(-1, NULL, 0);
+        if (pid < 0 && errno == EINTR) {
+            continue;
+        }
+        for (k = 0; k < jobs; k++) {
+            if (verifiers[k].pid && (verifiers[k].pid == pid || pid < 0)) {
+                lines[verifiers[k].index] = verifierResult(&verifiers[k], paths);
+            }
+        }
+
+        for (; printed < count && lines[printed]; printed++) {
+            fputs(lines[printed], stdout);
+            if (!strstr(lines[printed], "\",passed,")) {
+                failures++;
+            }
+            free(lines[printed]);
+        }
+        fflush(stdout);
+    }
+    free(lines);
+    free(verifiers);
+    return failures;
+}
+#endif
+
+// Replays every recording and saved game in directory without a display and prints one CSV line
+// for each. Returns the process exit code: 0 if they all passed, 1 otherwise.
+int runRecordingVerification(const char *directory, int jobs) {
+    struct timespec start;
+    char **paths;
+    int count, failures = 0, i;
+    double seconds;
+
+    currentConsole = autoplayConsole;
+    autoplayBatch = true;
+    nonInteractivePlayback = true;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    paths = listRecordings(directory, &count);
+    if (!paths) {
+        fprintf(stderr, "Could not read the directory %s\n", directory);
+        return 1;
+    }
+
+    printVerifyCsvHeader(stdout);
+    fflush(stdout);
+
+#ifdef _WIN32
+    failures = verifyRecordings(paths, count); // no fork(); replay everything in this process
+#else
+    failures = verifyRecordings(paths, count, clamp(jobs, 1, max(1, count)));
+#endif
+
+    seconds = secondsSince(&start);
+    fprintf(stderr, "Verified %i recordings in %.1f seconds: %i passed, %i failed\n",
+            count, seconds, count - failures, failures);
+
+    for (i = 0; i < count; i++) {
+        free(paths[i]);
+    }
+    free(paths);
+    return (failures ? 1 : 0);
+}
@@ -129,7 +129,9 @@ static void _delayUpTo(short ms) {
 }
 
 static boolean curses_pauseForMilliseconds(short milliseconds, PauseBehavior behavior) {
-    Term.refresh();
+    if (!behavior.skipScreenUpdate) {
+        Term.refresh();
+    }
     _delayUpTo(milliseconds);
 
     // hasKey returns true if we have a mouse event, too.
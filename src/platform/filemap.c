@@ -0,0 +1,68 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "platform.h"
+
+// Read-only views of whole files, used for playing back recordings. Where mmap() is available the
+// pages come straight from the system's file cache and are shared by every process replaying the
+// same file; elsewhere the file is read into memory in one go.
+
+#if defined(_WIN32) || defined(__OS2__)
+
+const unsigned char *mapFileForReading(const char *path, size_t *length) {
+    FILE *file = fopen(path, "rb");
+    unsigned char *data = NULL;
+    long size;
+
+    if (!file) {
+        return NULL;
+    }
+    if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) > 0) {
+        rewind(file);
+        data = malloc(size);
+        if (data && fread(data, 1, size, file) != (size_t) size) {
+            free(data);
+            data = NULL;
+        }
+        *length = size;
+    }
+    fclose(file);
+    return data;
+}
+
+void unmapFile(const unsigned char *data, size_t length) {
+    free((void *) data);
+}
+
+#else
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const unsigned char *mapFileForReading(const char *path, size_t *length) {
+    struct stat info;
+    void *data = MAP_FAILED;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            posix_madvise(data, info.st_size, POSIX_MADV_SEQUENTIAL); // playback reads front to back
+        }
+        *length = info.st_size;
+    }
+    close(fd); // the mapping stays valid
+    return (data == MAP_FAILED ? NULL : data);
+}
+
+void unmapFile(const unsigned char *data, size_t length) {
+    munmap((void *) data, length);
+}
+
+#endif
@@ -0,0 +1,102 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include "platform.h"
+
+// Forcing a file out to disk can take a long time on a busy or slow drive, so where threads are
+// available it is done on a helper thread. Only one request is kept: asking again for a file that
+// is still waiting its turn costs nothing.
+
+#if defined(_WIN32) || defined(__OS2__)
+
+#ifdef _WIN32
+#include <io.h>
+#endif
+
+static void flushAndSync(FILE *file) {
+    fflush(file);
+#ifdef _WIN32
+    _commit(_fileno(file));
+#endif
+}
+
+void syncFileInBackground(FILE *file) {
+    flushAndSync(file);
+}
+
+void syncFile(FILE *file) {
+    flushAndSync(file);
+}
+
+#else
+
+#include <pthread.h>
+#include <unistd.h>
+
+static pthread_mutex_t syncLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t syncRequested = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t syncFinished = PTHREAD_COND_INITIALIZER;
+static boolean syncThreadStarted = false;
+static FILE *pendingFile = NULL;    // waiting for the helper thread
+static FILE *syncingFile = NULL;    // being synced by the helper thread right now
+
+static void flushAndSync(FILE *file) {
+    fflush(file);
+    fsync(fileno(file));
+}
+
+static void *syncThreadMain(void *unused) {
+    pthread_mutex_lock(&syncLock);
+    for (;;) {
+        while (!pendingFile) {
+            pthread_cond_wait(&syncRequested, &syncLock);
+        }
+        syncingFile = pendingFile;
+        pendingFile = NULL;
+        pthread_mutex_unlock(&syncLock);
+
+        flushAndSync(syncingFile); // stdio locks the stream, so the game can keep writing to it
+
+        pthread_mutex_lock(&syncLock);
+        syncingFile = NULL;
+        pthread_cond_broadcast(&syncFinished);
+    }
+    return NULL;
+}
+
+static boolean startSyncThread() {
+    pthread_t thread;
+
+    if (!syncThreadStarted && pthread_create(&thread, NULL, syncThreadMain, NULL) == 0) {
+        pthread_detach(thread);
+        syncThreadStarted = true;
+    }
+    return syncThreadStarted;
+}
+
+void syncFileInBackground(FILE *file) {
+    pthread_mutex_lock(&syncLock);
+    if (!startSyncThread()) {
+        pthread_mutex_unlock(&syncLock);
+        flushAndSync(file);
+        return;
+    }
+    while (pendingFile && pendingFile != file) {
+        pthread_cond_wait(&syncFinished, &syncLock);
+    }
+    pendingFile = file;
+    pthread_cond_signal(&syncRequested);
+    pthread_mutex_unlock(&syncLock);
+}
+
+// Returns once the file is on disk; the caller may then close it.
+void syncFile(FILE *file) {
+    pthread_mutex_lock(&syncLock);
+    while (pendingFile == file || syncingFile == file) {
+        pthread_cond_wait(&syncFinished, &syncLock);
+    }
+    pthread_mutex_unlock(&syncLock);
+    flushAndSync(file);
+}
+
+#endif
@@ -12,6 +12,7 @@ struct brogueConsole currentConsole;
 char dataDirectory[BROGUE_FILENAME_MAX] = STRINGIFY(DATADIR);
 boolean serverMode = false;
 boolean nonInteractivePlayback = false;
+boolean autoplayBatch = false;
 boolean hasGraphics = false;
 enum graphicsModes graphicsMode = TEXT_GRAPHICS;
 boolean isCsvFormat = false;
@@ -35,9 +36,15 @@ static void printCommandlineHelp() {
     "--hybrid       -H          enable hybrid graphics\n"
     "--full-screen  -F          enable full screen\n"
     "--no-gpu                   disable hardware-accelerated graphics and HiDPI\n"
+    "--render-thread            present frames on a separate thread (experimental; not on macOS)\n"
+    "--max-fps N                with --render-thread, present at most N frames per second (default 60)\n"
+    "--no-batching              draw tiles one by one instead of in batches\n"
+    "--benchmark-rendering N    draw N frames of random tiles, print the time per frame and exit\n"
 #endif
 #ifdef BROGUE_CURSES
     "--term         -t          run in ncurses-based terminal mode\n"
+    "--term-direct              in terminal mode, write only changed cells with raw escape codes\n"
+    "--term-stats               in terminal mode, print bytes-per-frame statistics on exit\n"
 #endif
     "--variant variant_name     run a variant game (options: rapid_brogue, bullet_brogue)\n"
     "--stealth      -S          display stealth range\n"
@@ -48,6 +55,15 @@ static void printCommandlineHelp() {
     "                           (optional csv format)\n"
     "                           prints a catalog of the first LEVELS levels of NUM\n"
     "                           seeds from seed START (defaults: 1 1000 5)\n"
+    "--autoplay N               play N games unattended (seeds 1 to N) and print a CSV line for each\n"
+    "--seed-range FIRST:LAST    play the seeds FIRST to LAST unattended (with --autoplay N, the first N of them)\n"
+    "--jobs N                   with --autoplay or --verify-recordings, run N at a time in separate processes\n"
+    "--recording-buffer KB      buffer this much of the recording in memory between writes (default 64)\n"
+    "--recording-sync WHEN      force the recording to disk every turn, level or on exit (default level)\n"
+    "--state-hashes WHEN        store hashes of the game state in the recording every turn or level, so that\n"
+    "                           playback reports where and in what it first diverges (default off)\n"
+    "--pack-recording IN OUT    write the recording IN to OUT compressed, with an index of turns and depths\n"
+    "--verify-recordings DIR    replay every recording and saved game in DIR and print a CSV line for each\n"
     "--data-dir DIRECTORY       specify directory containing game resources (experimental)\n"
     );
     return;
@@ -108,6 +124,9 @@ int main(int argc, char *argv[])
     rogue.trueColorMode = false;
 
     enum graphicsModes initialGraphics = TEXT_GRAPHICS;
+    uint64_t autoplayGames = 0, autoplayFirstSeed = 1, autoplayLastSeed = 0;
+    int autoplayJobs = 1;
+    const char *verifyDirectory = NULL;
 
     int i;
     for (i = 1; i < argc; i++) {
@@ -232,6 +251,63 @@ int main(int argc, char *argv[])
             return errorCode;
         }
 
+        if (strcmp(argv[i], "--autoplay") == 0) {
+            if (i + 1 == argc || !tryParseUint64(argv[i + 1], &autoplayGames) || autoplayGames == 0) {
+                cliError("Bad number of games for --autoplay: ", i + 1 < argc ? argv[i + 1] : "");
+                return 1;
+            }
+            i++;
+            continue;
+        }
+
+        if (strcmp(argv[i], "--seed-range") == 0) {
+            char *colon = (i + 1 < argc ? strchr(argv[i + 1], ':') : NULL);
+            if (!colon) {
+                cliError("Bad seed range, expected FIRST:LAST: ", i + 1 < argc ? argv[i + 1] : "");
+                return 1;
+            }
+            *colon = '\0';
+            if (!tryParseUint64(argv[i + 1], &autoplayFirstSeed) || !tryParseUint64(colon + 1, &autoplayLastSeed)
+                || autoplayFirstSeed == 0 || autoplayLastSeed < autoplayFirstSeed) {
+                *colon = ':';
+                cliError("Bad seed range, expected FIRST:LAST: ", argv[i + 1]);
+                return 1;
+            }
+            i++;
+            continue;
+        }
+
+        if (strcmp(argv[i], "--jobs") == 0) {
+            if (i + 1 < argc && atoi(argv[i + 1]) > 0) {
+                autoplayJobs = atoi(argv[i + 1]);
+                i++;
+                continue;
+            }
+        }
+
+        if (strcmp(argv[i], "--verify-recordings") == 0) {
+            if (i + 1 < argc) {
+                verifyDirectory = argv[i + 1];
+                i++;
+                continue;
+            }
+        }
+
+        if (strcmp(argv[i], "--pack-recording") == 0) {
+            if (i + 2 < argc) {
+                int errorCode;
+                char errorMessage[ERROR_MESSAGE_LENGTH];
+
+                currentConsole = nullConsole;
+                nonInteractivePlayback = true;
+                errorCode = packRecording(argv[i + 1], argv[i + 2], errorMessage);
+                if (errorCode) {
+                    cliError("Could not pack recording: ", errorMessage);
+                }
+                return errorCode;
+            }
+        }
+
         if (strcmp(argv[i], "-V") == 0 || strcmp(argv[i], "--version") == 0) {
             printBrogueVersion();
             return 0;
@@ -280,6 +356,42 @@ int main(int argc, char *argv[])
             softwareRendering = true;
             continue;
         }
+
+        if (strcmp(argv[i], "--render-thread") == 0) {
+#ifdef __APPLE__
+            // SDL only supports rendering from the main thread, and Cocoa enforces it
+            cliError("--render-thread is not supported on macOS", "");
+            return 1;
+#else
+            renderThreadEnabled = true;
+            continue;
+#endif
+        }
+
+        if (strcmp(argv[i], "--no-batching") == 0) {
+            batchedRendering = false;
+            continue;
+        }
+
+        if (strcmp(argv[i], "--benchmark-rendering") == 0) {
+            if (i + 1 < argc) {
+                renderBenchmarkFrames = max(1, atoi(argv[i + 1]));
+                i++;
+                continue;
+            }
+        }
+
+        if (strcmp(argv[i], "--max-fps") == 0) {
+            if (i + 1 < argc) {
+                int fps = atoi(argv[i + 1]);
+                if (fps > 0 && fps <= 1000) {
+                    maxFramesPerSecond = fps;
+                }
+
+                i++;
+                continue;
+            }
+        }
 #endif
 
 #ifdef BROGUE_CURSES
@@ -287,6 +399,16 @@ int main(int argc, char *argv[])
             currentConsole = cursesConsole;
             continue;
         }
+
+        if (strcmp(argv[i], "--term-direct") == 0) {
+            directTerminalRendering = true;
+            continue;
+        }
+
+        if (strcmp(argv[i], "--term-stats") == 0) {
+            terminalRenderStats = true;
+            continue;
+        }
 #endif
 
 #ifdef BROGUE_WEB
@@ -318,6 +440,48 @@ int main(int argc, char *argv[])
             continue;
         }
 
+        if (strcmp(argv[i], "--recording-buffer") == 0) {
+            if (i + 1 < argc && atoi(argv[i + 1]) > 0) {
+                recordingStreamBufferSize = (unsigned long) atoi(argv[i + 1]) * 1024;
+                i++;
+                continue;
+            }
+        }
+
+        if (strcmp(argv[i], "--recording-sync") == 0) {
+            if (i + 1 < argc) {
+                if (!strcmp(argv[i + 1], "turn")) {
+                    recordingSyncPolicy = RECORDING_SYNC_TURN;
+                } else if (!strcmp(argv[i + 1], "level")) {
+                    recordingSyncPolicy = RECORDING_SYNC_LEVEL;
+                } else if (!strcmp(argv[i + 1], "exit")) {
+                    recordingSyncPolicy = RECORDING_SYNC_EXIT;
+                } else {
+                    cliError("Bad argument for --recording-sync (expected turn, level or exit): ", argv[i + 1]);
+                    return 1;
+                }
+                i++;
+                continue;
+            }
+        }
+
+        if (strcmp(argv[i], "--state-hashes") == 0) {
+            if (i + 1 < argc) {
+                if (!strcmp(argv[i + 1], "turn")) {
+                    stateHashPolicy = STATE_HASHES_TURN;
+                } else if (!strcmp(argv[i + 1], "level")) {
+                    stateHashPolicy = STATE_HASHES_LEVEL;
+                } else if (!strcmp(argv[i + 1], "off")) {
+                    stateHashPolicy = STATE_HASHES_OFF;
+                } else {
+                    cliError("Bad argument for --state-hashes (expected turn, level or off): ", argv[i + 1]);
+                    return 1;
+                }
+                i++;
+                continue;
+            }
+        }
+
         if (strcmp(argv[i], "--data-dir") == 0) {
             if (i + 1 < argc) {
                 strcpy(dataDirectory, argv[++i]);
@@ -344,6 +508,21 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    if (verifyDirectory) {
+        // Like --autoplay below, handled last so that --variant and --jobs can appear anywhere.
+        return runRecordingVerification(verifyDirectory, autoplayJobs);
+    }
+
+    if (autoplayGames || autoplayLastSeed) {
+        // Parsed last so that --variant applies wherever it appears on the command line.
+        if (!autoplayLastSeed) {
+            autoplayLastSeed = autoplayFirstSeed + autoplayGames - 1;
+        } else if (autoplayGames && autoplayGames - 1 < autoplayLastSeed - autoplayFirstSeed) {
+            autoplayLastSeed = autoplayFirstSeed + autoplayGames - 1;
+        }
+        return runAutoplayBatch(autoplayFirstSeed, autoplayLastSeed, autoplayJobs);
+    }
+
     hasGraphics = (currentConsole.setGraphicsMode != NULL);
     // Now actually set graphics. We do this to ensure there is exactly one
     // call, whether true or false
@@ -92,6 +92,8 @@ void dumpScores(void);
 unsigned int glyphToUnicode(enum displayGlyph glyph);
 boolean isEnvironmentGlyph(enum displayGlyph glyph);
 void setHighScoresFilename(char *buffer, int bufferMaxLength);
+int runAutoplayBatch(uint64_t firstSeed, uint64_t lastSeed, int jobs);
+int runRecordingVerification(const char *directory, int jobs);
 
 #ifdef BROGUE_SDL
 extern struct brogueConsole sdlConsole;
@@ -99,10 +101,16 @@ extern int windowWidth;
 extern int windowHeight;
 extern boolean fullScreen;
 extern boolean softwareRendering;
+extern boolean renderThreadEnabled;
+extern int maxFramesPerSecond;
+extern boolean batchedRendering;
+extern int renderBenchmarkFrames;
 #endif
 
 #ifdef BROGUE_CURSES
 extern struct brogueConsole cursesConsole;
+extern boolean directTerminalRendering;
+extern boolean terminalRenderStats;
 #endif
 
 #ifdef BROGUE_WEB
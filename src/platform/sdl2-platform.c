@@ -21,6 +21,8 @@ static enum graphicsModes showGraphics = TEXT_GRAPHICS;
 
 static rogueEvent lastEvent;
 
+int renderBenchmarkFrames = 0;  // if non-zero, run the rendering benchmark instead of the game
+
 
 static void sdlfatal(char *file, int line) {
     fprintf(stderr, "Fatal SDL error (%s:%d): %s\n", file, line, SDL_GetError());
@@ -154,10 +156,18 @@ static boolean pollBrogueEvent(rogueEvent *returnEvent, boolean textInput) {
     boolean ret = false;
 
 
+    // With a render thread, window events must not be processed while it is drawing, as they
+    // may resize the renderer's output. If it's busy, we'll get them next time.
+    if (lockRenderer(false)) {
+        SDL_PumpEvents();
+        unlockRenderer();
+    }
+
     // ~ for (int i=0; i < 100 && SDL_PollEvent(&event); i++) {
-    while (SDL_PollEvent(&event)) {
+    while (SDL_PeepEvents(&event, 1, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT) > 0) {
         if (event.type == SDL_QUIT) {
             // the player clicked the X button!
+            stopRenderThread();
             SDL_Quit();
             int statusCode = quitImmediately();
             exit(statusCode);
@@ -275,8 +285,15 @@ static void _gameLoop() {
 
     resizeWindow(windowWidth, windowHeight);
 
+    if (renderBenchmarkFrames) {
+        benchmarkRendering(renderBenchmarkFrames);
+        SDL_Quit();
+        exit(EXIT_STATUS_SUCCESS);
+    }
+
     int statusCode = rogueMain();
 
+    stopRenderThread();
     SDL_Quit();
 
     exit(statusCode);
@@ -298,7 +315,9 @@ static void _delayUpTo(short ms) {
 }
 
 static boolean _pauseForMilliseconds(short ms, PauseBehavior behavior) {
-    updateScreen();
+    if (!behavior.skipScreenUpdate) {
+        updateScreen();
+    }
     _delayUpTo(ms);
 
     if (lastEvent.eventType != EVENT_ERROR
@@ -5,6 +5,9 @@
 #include <string.h>
 #include "Rogue.h"
 #include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <unistd.h>
 
 
 // As a rule, everything in term.c is the result of gradual evolutionary
@@ -22,6 +25,7 @@ static struct { int curses, color; } videomode = { 0, 0 };
 static struct { int width, height; } minsize = { 80, 24 };
 
 static void init_coersion();
+static void print_render_stats(void);
 
 
 // 256 color mode stuff
@@ -52,6 +56,9 @@ enum {
 
 int is_xterm;
 
+boolean directTerminalRendering = false; // use buffer_render_direct in 256-color and truecolor modes
+boolean terminalRenderStats = false;     // print bytes-per-frame statistics on exit
+
 
 //
 
@@ -179,6 +186,10 @@ static void term_end() {
     clear();
     refresh();
     endwin();
+
+    if (terminalRenderStats) {
+        print_render_stats();
+    }
 }
 
 typedef struct CIE {
@@ -547,9 +558,58 @@ static void buffer_render_256() {
 
 static int fullRefresh = 1; // screen needs a full refresh
 
+// Direct renderer: instead of going through ncurses (256-color mode) or
+// printf-ing every dirty cell (truecolor mode), compare the cell buffer with
+// what we last sent to the terminal, and write only the cells that changed.
+// Foreground and background changes share one SGR sequence, the cursor is
+// only moved when a span of changed cells is interrupted, and the whole frame
+// goes out in a single write().
+
+static pairmode_cell *shown_buffer; // what the terminal is currently displaying
+
+static struct {
+    char *data;
+    size_t length, capacity;
+    boolean dropped; // some output was lost, so the screen no longer matches shown_buffer
+} frame;
+
+static struct {
+    unsigned long frames, emptyFrames;
+    unsigned long long bytes;
+    size_t maxBytes;
+} renderStats;
+
+static void record_frame_stats(size_t bytes) {
+    renderStats.frames++;
+    if (bytes == 0) {
+        renderStats.emptyFrames++;
+    }
+    renderStats.bytes += bytes;
+    if (bytes > renderStats.maxBytes) {
+        renderStats.maxBytes = bytes;
+    }
+}
+
+static void print_render_stats(void) {
+    unsigned long drawn = renderStats.frames - renderStats.emptyFrames;
+    const char *renderer = (directTerminalRendering && colormode != coerce_16) ? "direct"
+        : (colormode == truecolor ? "24-bit" : "curses");
+
+    if (colormode != truecolor && !(directTerminalRendering && colormode == coerce_256)) {
+        // ncurses does its own output; we can't count its bytes
+        fprintf(stderr, "Render stats: not available for the %s renderer\n", renderer);
+        return;
+    }
+    fprintf(stderr, "Render stats (%s renderer): %lu frames (%lu unchanged), %llu bytes, "
+            "%.1f bytes/frame average, %zu bytes max\n",
+            renderer, renderStats.frames, renderStats.emptyFrames, renderStats.bytes,
+            drawn ? (double) renderStats.bytes / drawn : 0.0, renderStats.maxBytes);
+}
+
 static void buffer_render_24bit() {
     int cx, cy;      // cursor coordinates
     intcolor fg, bg; // current colors
+    size_t bytes = 0;
 
     cx = cy = fg.r = fg.g = fg.b = bg.r = bg.g = bg.b = -1;
 
@@ -564,29 +624,178 @@ static void buffer_render_24bit() {
             // change background color
             if (c->back.r != bg.r || c->back.g != bg.g || c->back.b != bg.b) {
                 bg = c->back;
-                printf("\033[48;2;%d;%d;%dm", bg.r, bg.g, bg.b);
+                bytes += printf("\033[48;2;%d;%d;%dm", bg.r, bg.g, bg.b);
             }
 
             // change foreground color (doesn't matter for whitespace)
             if (c->ch != ' ' && (fg.r != c->fore.r || fg.g != c->fore.g || fg.b != c->fore.b)) {
                 fg = c->fore;
-                printf("\033[38;2;%d;%d;%dm", fg.r, fg.g, fg.b);
+                bytes += printf("\033[38;2;%d;%d;%dm", fg.r, fg.g, fg.b);
             }
 
             // move cursor if necessary
             if (cx != x || cy != y) {
                 cx = x, cy = y;
-                printf("\033[%d;%df", cy+1, cx+1);
+                bytes += printf("\033[%d;%df", cy+1, cx+1);
             }
 
             // print the character
-            printf("%c", c->ch);
+            bytes += printf("%c", c->ch);
             cx++;
         }
     }
 
     fflush(stdout);
     fullRefresh = 0;
+
+    if (terminalRenderStats) {
+        record_frame_stats(bytes);
+    }
+}
+
+static void frame_append(const char *str, size_t length) {
+    if (frame.length + length > frame.capacity) {
+        size_t capacity = frame.capacity ? frame.capacity * 2 : 4096;
+        while (capacity < frame.length + length) capacity *= 2;
+        char *data = realloc(frame.data, capacity);
+        if (data == NULL) {
+            frame.dropped = true; // buffer_render_direct will redraw everything next frame
+            return;
+        }
+        frame.data = data;
+        frame.capacity = capacity;
+    }
+    memcpy(frame.data + frame.length, str, length);
+    frame.length += length;
+}
+
+static void frame_printf(const char *format, ...) {
+    char buf[64];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (length > 0) {
+        frame_append(buf, length < (int) sizeof(buf) ? length : sizeof(buf) - 1);
+    }
+}
+
+static void frame_write() {
+    // anything printf-ed earlier (e.g. the title) has to reach the terminal first
+    fflush(stdout);
+
+    size_t written = 0;
+    while (written < frame.length) {
+        ssize_t n = write(STDOUT_FILENO, frame.data + written, frame.length - written);
+        if (n <= 0) break;
+        written += n;
+    }
+    frame.length = 0;
+}
+
+static boolean same_intcolor(const intcolor *a, const intcolor *b) {
+    return a->r == b->r && a->g == b->g && a->b == b->b && a->idx == b->idx;
+}
+
+// Whether a cell looks different on screen (the foreground of a space can't be seen)
+static boolean cell_differs(const pairmode_cell *a, const pairmode_cell *b) {
+    return a->ch != b->ch
+        || !same_intcolor(&a->back, &b->back)
+        || (a->ch != ' ' && !same_intcolor(&a->fore, &b->fore));
+}
+
+// Whether the cell can be printed without changing the current SGR state
+static boolean cell_matches_sgr(const pairmode_cell *c, const intcolor *fg, const intcolor *bg) {
+    return same_intcolor(&c->back, bg) && (c->ch == ' ' || same_intcolor(&c->fore, fg));
+}
+
+static void frame_sgr(const pairmode_cell *c, intcolor *fg, intcolor *bg) {
+    boolean changeFg = (c->ch != ' ' && !same_intcolor(&c->fore, fg));
+    boolean changeBg = !same_intcolor(&c->back, bg);
+
+    if (!changeFg && !changeBg) return;
+
+    frame_append("\033[", 2);
+    if (changeFg) {
+        *fg = c->fore;
+        if (colormode == truecolor) {
+            frame_printf("38;2;%d;%d;%d", fg->r, fg->g, fg->b);
+        } else {
+            frame_printf("38;5;%d", fg->idx);
+        }
+    }
+    if (changeBg) {
+        *bg = c->back;
+        if (colormode == truecolor) {
+            frame_printf(changeFg ? ";48;2;%d;%d;%d" : "48;2;%d;%d;%d", bg->r, bg->g, bg->b);
+        } else {
+            frame_printf(changeFg ? ";48;5;%d" : "48;5;%d", bg->idx);
+        }
+    }
+    frame_append("m", 1);
+}
+
+// Longest run of unchanged cells we reprint rather than jump over with a cursor movement
+#define DIRECT_MAX_REPRINT_GAP 4
+
+static void buffer_render_direct() {
+    const int width = minsize.width, height = minsize.height;
+    int cx = -1, cy = -1;           // cursor position, unknown at the start of a frame
+    intcolor fg = {-1, -1, -1, -1}; // SGR state, also unknown
+    intcolor bg = {-1, -1, -1, -1};
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int i = x + y * width;
+            pairmode_cell *c = &cell_buffer[i];
+
+            if (!fullRefresh && !cell_differs(c, &shown_buffer[i])) continue;
+
+            if (cy == y && x > cx && x - cx <= DIRECT_MAX_REPRINT_GAP) {
+                // a short gap on this row: reprinting it is cheaper than moving
+                // the cursor, as long as it doesn't need any color changes
+                int gx;
+                for (gx = cx; gx < x; gx++) {
+                    if (!cell_matches_sgr(&cell_buffer[gx + y * width], &fg, &bg)) break;
+                }
+                if (gx == x) {
+                    for (gx = cx; gx < x; gx++) {
+                        char ch = cell_buffer[gx + y * width].ch;
+                        frame_append(&ch, 1);
+                    }
+                    cx = x;
+                }
+            }
+
+            if (cx != x || cy != y) {
+                if (cy == y && x > cx) {
+                    frame_printf("\033[%dC", x - cx);
+                } else if (x == 0) {
+                    frame_printf("\033[%dH", y + 1);
+                } else {
+                    frame_printf("\033[%d;%dH", y + 1, x + 1);
+                }
+                cx = x, cy = y;
+            }
+
+            frame_sgr(c, &fg, &bg);
+
+            char ch = c->ch;
+            frame_append(&ch, 1);
+            shown_buffer[i] = *c;
+            c->pair = 0;
+
+            // Don't rely on where the cursor ends up after the last column
+            cx = (x + 1 < width) ? x + 1 : -1;
+        }
+    }
+
+    if (terminalRenderStats) {
+        record_frame_stats(frame.length);
+    }
+    frame_write();
+    fullRefresh = frame.dropped;
+    frame.dropped = false;
 }
 
 static void term_mvaddch(int x, int y, int ch, fcolor *fg, fcolor *bg) {
@@ -627,7 +836,9 @@ static void term_refresh() {
         }
     }
 
-    if (colormode == truecolor) {
+    if (directTerminalRendering && colormode != coerce_16) {
+        buffer_render_direct();
+    } else if (colormode == truecolor) {
         buffer_render_24bit();
     } else if (colormode == coerce_256) {
         buffer_render_256();
@@ -734,6 +945,9 @@ static void term_resize(int w, int h) {
 
     if (cell_buffer) free(cell_buffer);
     cell_buffer = malloc(sizeof(pairmode_cell) * w * h);
+    if (shown_buffer) free(shown_buffer);
+    shown_buffer = calloc(w * h, sizeof(pairmode_cell));
+    fullRefresh = 1;
     // add error checking
     int i;
 
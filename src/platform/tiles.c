@@ -16,6 +16,10 @@
 #define TEXT_BASELINE  46   // height (px) of the blank space below the 'x' outline
 #define MAX_TILE_SIZE  64   // maximum width or height (px) of screen tiles before we switch to linear interpolation
 
+#define TILE_CACHE_FILE     "TilesCache.bin"  // downscaled tiles from previous launches, in the working directory
+#define TILE_CACHE_VERSION  2                 // bump when downscaleTile() or the header changes, to invalidate old caches
+#define TILE_CACHE_MAX_SIZE (64 << 20)        // start over when the cache file grows larger than this (bytes)
+
 
 // How each tile should be processed:
 //  -  's' = stretch: tile stretches to fill the space
@@ -39,9 +43,13 @@ typedef struct ScreenTile {
 } ScreenTile;
 
 static SDL_Window *Win = NULL;      // the SDL window
-static SDL_Surface *TilesPNG;       // source PNG
+static SDL_Surface *TilesPNG = NULL; // source PNG (only loaded when some tiles are not in the cache)
+static uint64_t tilesPNGHash;       // hash of the PNG file, which identifies the cache that goes with it
+static uint64_t tilesBinHash;       // hash of tiles.bin, whose shifts are also kept in the cache
 static SDL_Texture *Textures[4];    // textures used by the renderer to draw tiles
 static int numTextures = 0;         // how many textures are available in `Textures`
+static int textureWidth[4];         // width (px) of each texture in `Textures`
+static int textureHeight[4];        // height (px) of each texture in `Textures`
 static int8_t tilePadding[TILE_ROWS][TILE_COLS];  // how many black lines are at the top/bottom of each tile in the source PNG
 static boolean tileEmpty[TILE_ROWS][TILE_COLS];   // true if a tile is completely black in the source PNG, else false
 
@@ -62,6 +70,24 @@ int windowWidth = -1;               // the SDL window's width (in "screen units"
 int windowHeight = -1;              // the SDL window's height (in "screen units", not pixels)
 boolean fullScreen = false;         // true if the window should be full-screen, else false
 boolean softwareRendering = false;  // true if hardware acceleration is disabled (by choice or by force)
+boolean renderThreadEnabled = false; // true if presentation should happen on a separate render thread
+int maxFramesPerSecond = 60;        // how often the render thread may present a frame
+
+// Render thread state. The game thread publishes snapshots of `screenTiles` into one of three
+// slots; the render thread picks up the latest one. `sharedSnapshot` holds the index of the slot
+// that neither thread is using, plus SNAPSHOT_FRESH if it holds a frame the render thread hasn't seen.
+#define SNAPSHOT_FRESH  4
+static ScreenTile snapshots[3][ROWS][COLS];
+static SDL_atomic_t sharedSnapshot;
+static int publishedSnapshot = 0;   // slot the game thread writes into (game thread only)
+static int presentedSnapshot = 2;   // slot the render thread reads from (render thread only)
+static ScreenTile drawnTiles[ROWS][COLS];  // what the render thread last drew (render thread only)
+static SDL_Thread *renderThread = NULL;
+static SDL_atomic_t renderThreadQuit;
+static SDL_mutex *rendererLock = NULL;     // held while the render thread uses the renderer
+static SDL_atomic_t screenshotRequested;
+static SDL_sem *screenshotTaken = NULL;
+static SDL_Surface *screenshot = NULL;
 
 
 /// Prints the fatal error message provided by SDL then closes the app.
@@ -442,7 +468,184 @@ static void optimizeTiles() {
 }
 
 
+/// Header of the tile cache file. It holds everything we learn from analysing the PNG,
+/// so that a launch with a valid cache doesn't need to decode the PNG at all.
+typedef struct TileCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint64_t pngHash;
+    uint64_t binHash;
+    int8_t padding[TILE_ROWS][TILE_COLS];
+    boolean empty[TILE_ROWS][TILE_COLS];
+    int8_t shifts[TILE_ROWS][TILE_COLS][2][MAX_TILE_SIZE][3];
+} TileCacheHeader;
+
+/// The header is followed by any number of downscaled textures, each of them an entry
+/// followed by the alpha channel of all tiles (tileWidth * TILE_COLS by tileHeight * TILE_ROWS bytes).
+typedef struct TileCacheEntry {
+    int32_t baseTileWidth, baseTileHeight;  // the downscaling depends on these...
+    int32_t tileWidth, tileHeight;          // ... as well as on the actual tile size
+} TileCacheEntry;
+
+static const char TileCacheMagic[8] = "BRTILES";
+
+
+/// Returns a 64-bit FNV-1a hash of a file's contents, or 0 if it can't be read.
+static uint64_t hashFile(const char *filename) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) return 0;
+
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    unsigned char buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            hash = (hash ^ buffer[i]) * 0x100000001b3ULL;
+        }
+    }
+    fclose(file);
+    return hash;
+}
+
+
+/// Loads the PNG into `TilesPNG`, if it's not already loaded.
+static void loadTilesPNG() {
+    if (TilesPNG) return;
+
+    char filename[BROGUE_FILENAME_MAX];
+    sprintf(filename, "%s/assets/tiles.png", dataDirectory);
+
+    // load the large PNG
+    SDL_Surface *image = IMG_Load(filename);
+    if (!image) imgfatal(__FILE__, __LINE__);
+    TilesPNG = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_ARGB8888, 0);
+    if (!TilesPNG) sdlfatal(__FILE__, __LINE__);
+    SDL_FreeSurface(image);
+}
+
+
+/// Reads the tile cache header and, if it belongs to the current PNG and tiles.bin, restores the padding,
+/// emptiness and shift tables from it. Returns false if there is no usable cache.
+static boolean loadTileCacheHeader() {
+    FILE *file = fopen(TILE_CACHE_FILE, "rb");
+    if (!file) return false;
+
+    TileCacheHeader *header = malloc(sizeof(TileCacheHeader));
+    boolean valid = (header
+        && fread(header, sizeof(TileCacheHeader), 1, file) == 1
+        && !memcmp(header->magic, TileCacheMagic, sizeof(TileCacheMagic))
+        && header->version == TILE_CACHE_VERSION
+        && header->pngHash == tilesPNGHash
+        && header->binHash == tilesBinHash);
+    fclose(file);
+
+    if (valid) {
+        memcpy(tilePadding, header->padding, sizeof(tilePadding));
+        memcpy(tileEmpty, header->empty, sizeof(tileEmpty));
+        memcpy(tileShifts, header->shifts, sizeof(tileShifts));
+    }
+    free(header);
+    return valid;
+}
+
+
+/// Starts a new, empty tile cache for the current PNG, replacing any previous one.
+static void writeTileCacheHeader() {
+    TileCacheHeader *header = calloc(1, sizeof(TileCacheHeader));
+    if (!header) return;
+    memcpy(header->magic, TileCacheMagic, sizeof(TileCacheMagic));
+    header->version = TILE_CACHE_VERSION;
+    header->pngHash = tilesPNGHash;
+    header->binHash = tilesBinHash;
+    memcpy(header->padding, tilePadding, sizeof(tilePadding));
+    memcpy(header->empty, tileEmpty, sizeof(tileEmpty));
+    memcpy(header->shifts, tileShifts, sizeof(tileShifts));
+
+    FILE *file = fopen(TILE_CACHE_FILE, "wb");
+    if (file) {
+        fwrite(header, sizeof(TileCacheHeader), 1, file);
+        fclose(file);
+    } else {
+        fprintf(stderr, "Warning: could not write to \"%s\"\n", TILE_CACHE_FILE);
+    }
+    free(header);
+}
+
+
+/// Looks for tiles downscaled to the given size in the cache, and copies them to `surface` if found.
+static boolean loadCachedTiles(SDL_Surface *surface, int tileWidth, int tileHeight) {
+    FILE *file = fopen(TILE_CACHE_FILE, "rb");
+    if (!file) return false;
+
+    boolean found = false;
+    TileCacheEntry entry;
+    if (fseek(file, sizeof(TileCacheHeader), SEEK_SET) == 0) {
+        while (fread(&entry, sizeof(entry), 1, file) == 1) {
+            long size = (long)entry.tileWidth * TILE_COLS * entry.tileHeight * TILE_ROWS;
+            if (entry.baseTileWidth != baseTileWidth || entry.baseTileHeight != baseTileHeight
+                || entry.tileWidth != tileWidth || entry.tileHeight != tileHeight) {
+                if (size <= 0 || fseek(file, size, SEEK_CUR) != 0) break;
+                continue;
+            }
+
+            // found it: expand the alpha channel to white pixels
+            uint8_t *alpha = malloc(tileWidth * TILE_COLS);
+            found = (alpha != NULL);
+            for (int y = 0; found && y < tileHeight * TILE_ROWS; y++) {
+                if (fread(alpha, tileWidth * TILE_COLS, 1, file) != 1) {
+                    found = false;
+                    break;
+                }
+                Uint32 *pixel = (Uint32 *)((uint8_t *)surface->pixels + y * surface->pitch);
+                for (int x = 0; x < tileWidth * TILE_COLS; x++) {
+                    *pixel++ = ((uint32_t)alpha[x] << 24) | 0xffffffU;
+                }
+            }
+            free(alpha);
+            break;
+        }
+    }
+    fclose(file);
+    return found;
+}
+
+
+/// Appends tiles downscaled to the given size to the cache.
+static void saveCachedTiles(SDL_Surface *surface, int tileWidth, int tileHeight) {
+    FILE *file = fopen(TILE_CACHE_FILE, "rb");
+    if (!file) return; // the header couldn't be written, so don't bother
+    fseek(file, 0, SEEK_END);
+    long cacheSize = ftell(file);
+    fclose(file);
+
+    if (cacheSize > TILE_CACHE_MAX_SIZE) {
+        writeTileCacheHeader(); // don't grow forever when the window is resized a lot
+    }
+
+    file = fopen(TILE_CACHE_FILE, "ab");
+    if (!file) return;
+
+    TileCacheEntry entry = {baseTileWidth, baseTileHeight, tileWidth, tileHeight};
+    uint8_t *alpha = malloc(tileWidth * TILE_COLS);
+    if (alpha && fwrite(&entry, sizeof(entry), 1, file) == 1) {
+        for (int y = 0; y < tileHeight * TILE_ROWS; y++) {
+            Uint32 *pixel = (Uint32 *)((uint8_t *)surface->pixels + y * surface->pitch);
+            for (int x = 0; x < tileWidth * TILE_COLS; x++) {
+                alpha[x] = *pixel++ >> 24;
+            }
+            if (fwrite(alpha, tileWidth * TILE_COLS, 1, file) != 1) break;
+        }
+    }
+    free(alpha);
+    fclose(file);
+}
+
+
 /// Loads the PNG and analyses it.
+///
+/// The analysis, together with the downscaled textures, is kept in a cache file keyed by hashes of the PNG
+/// and of tiles.bin, so on later launches we only need to read the cache, and don't even decode the PNG unless a new tile size
+/// comes up.
 void initTiles() {
     char filename[BROGUE_FILENAME_MAX];
     sprintf(filename, "%s/assets/tiles.png", dataDirectory);
@@ -453,12 +656,14 @@ void initTiles() {
         exit(EXIT_STATUS_FAILURE_PLATFORM_ERROR);
     }
 
-    // load the large PNG
-    SDL_Surface *image = IMG_Load(filename);
-    if (!image) imgfatal(__FILE__, __LINE__);
-    TilesPNG = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_ARGB8888, 0);
-    if (!TilesPNG) sdlfatal(__FILE__, __LINE__);
-    SDL_FreeSurface(image);
+    tilesPNGHash = hashFile(filename);
+    sprintf(filename, "%s/assets/tiles.bin", dataDirectory);
+    tilesBinHash = hashFile(filename);
+    if (loadTileCacheHeader()) {
+        return;
+    }
+
+    loadTilesPNG();
 
     // measure padding
     for (int row = 0; row < TILE_ROWS; row++) {
@@ -484,7 +689,10 @@ void initTiles() {
         }
         fwrite(tileShifts, 1, sizeof(tileShifts), file);
         fclose(file);
+        tilesBinHash = hashFile(filename);
     }
+
+    writeTileCacheHeader();
 }
 
 
@@ -557,16 +765,22 @@ static void createTextures(SDL_Renderer *renderer, int outputWidth, int outputHe
         while (surfaceWidth < tileWidth * TILE_COLS) surfaceWidth *= 2;
         while (surfaceHeight < tileHeight * TILE_ROWS) surfaceHeight *= 2;
 
-        // downscale the tiles
+        // downscale the tiles, unless we did it on a previous launch
         SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, surfaceWidth, surfaceHeight, 32, SDL_PIXELFORMAT_ARGB8888);
         if (!surface) sdlfatal(__FILE__, __LINE__);
-        for (int row = 0; row < TILE_ROWS; row++) {
-            for (int column = 0; column < TILE_COLS; column++) {
-                downscaleTile(surface, tileWidth, tileHeight, row, column, false);
+        if (!loadCachedTiles(surface, tileWidth, tileHeight)) {
+            loadTilesPNG();
+            for (int row = 0; row < TILE_ROWS; row++) {
+                for (int column = 0; column < TILE_COLS; column++) {
+                    downscaleTile(surface, tileWidth, tileHeight, row, column, false);
+                }
             }
+            saveCachedTiles(surface, tileWidth, tileHeight);
         }
 
         // convert to texture
+        textureWidth[i] = surfaceWidth;
+        textureHeight[i] = surfaceHeight;
         Textures[i] = SDL_CreateTextureFromSurface(renderer, surface);
         if (!Textures[i]) sdlfatal(__FILE__, __LINE__);
         if (SDL_SetTextureBlendMode(Textures[i], SDL_BLENDMODE_BLEND) < 0) sdlfatal(__FILE__, __LINE__);
@@ -604,6 +818,62 @@ void updateTile(int row, int column, short charIndex,
 }
 
 
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+
+#define MAX_QUADS (ROWS * COLS)
+
+boolean batchedRendering = true;   // false to draw tiles one by one, or if SDL_RenderGeometry failed
+static SDL_Vertex batchVertices[MAX_QUADS * 4];
+static int batchIndices[MAX_QUADS * 6];
+
+/// Adds a rectangle to the current batch of geometry.
+///
+/// \param quad index of the rectangle in the batch
+/// \param dest where to draw it (px)
+/// \param color vertex color, which multiplies the texture like SDL_SetTextureColorMod
+/// \param src area of the texture to draw, or NULL for a solid rectangle
+/// \param textureIndex which of `Textures` src refers to
+///
+static void addQuad(int quad, const SDL_Rect *dest, SDL_Color color, const SDL_Rect *src, int textureIndex) {
+    SDL_Vertex *v = &batchVertices[quad * 4];
+    float x0 = dest->x, y0 = dest->y, x1 = dest->x + dest->w, y1 = dest->y + dest->h;
+    float u0 = 0, v0 = 0, u1 = 0, v1 = 0;
+
+    if (src) {
+        u0 = (float)src->x / textureWidth[textureIndex];
+        v0 = (float)src->y / textureHeight[textureIndex];
+        u1 = (float)(src->x + src->w) / textureWidth[textureIndex];
+        v1 = (float)(src->y + src->h) / textureHeight[textureIndex];
+    }
+
+    v[0] = (SDL_Vertex){{x0, y0}, color, {u0, v0}};
+    v[1] = (SDL_Vertex){{x1, y0}, color, {u1, v0}};
+    v[2] = (SDL_Vertex){{x0, y1}, color, {u0, v1}};
+    v[3] = (SDL_Vertex){{x1, y1}, color, {u1, v1}};
+}
+
+/// Submits the current batch in a single draw call. Returns false if the renderer can't draw geometry.
+static boolean drawBatch(SDL_Renderer *renderer, SDL_Texture *texture, int quads) {
+    if (batchIndices[1] == 0) {
+        // two triangles per rectangle; the pattern never changes
+        for (int i = 0; i < MAX_QUADS; i++) {
+            int *index = &batchIndices[i * 6];
+            index[0] = i * 4;     index[1] = i * 4 + 1; index[2] = i * 4 + 2;
+            index[3] = i * 4 + 2; index[4] = i * 4 + 1; index[5] = i * 4 + 3;
+        }
+    }
+
+    if (quads == 0) return true;
+    return SDL_RenderGeometry(renderer, texture, batchVertices, quads * 4, batchIndices, quads * 6) == 0;
+}
+
+#else
+
+boolean batchedRendering = false;  // SDL_RenderGeometry needs SDL 2.0.18
+
+#endif
+
+
 /// Draws everything on screen.
 ///
 /// OpenGL drivers don't like alternating between different textures too much, so we
@@ -618,9 +888,11 @@ void updateTile(int row, int column, short charIndex,
 /// This works because, unlike the accelerated renderers, the software renderer draws on a
 /// single surface and doesn't do double-buffering.
 ///
-void updateScreen() {
-    if (!Win) return;
-
+/// With SDL 2.0.18 or later, each of the 5 steps is sent to the renderer as a single batch of
+/// geometry rather than one call per tile. If the renderer can't do that, we fall back to
+/// drawing tiles one by one.
+///
+static void renderTiles(ScreenTile tiles[ROWS][COLS]) {
     SDL_Renderer *renderer = SDL_GetRenderer(Win);
     if (!renderer) {
         renderer = SDL_CreateRenderer(Win, -1, (softwareRendering ? SDL_RENDERER_SOFTWARE : 0));
@@ -653,7 +925,14 @@ void updateScreen() {
     //  2.  Textures[2]
     //  3.  Textures[3]
 
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    boolean batching = batchedRendering;
+#endif
+
     for (int step = -1; step < numTextures; step++) {
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        int quads = 0;
+#endif
 
         for (int x = 0; x < COLS; x++) {
             int tileWidth = ((x+1) * outputWidth / COLS) - (x * outputWidth / COLS);
@@ -663,7 +942,7 @@ void updateScreen() {
                 int tileHeight = ((y+1) * outputHeight / ROWS) - (y * outputHeight / ROWS);
                 if (tileHeight == 0) continue;
 
-                ScreenTile *tile = &screenTiles[y][x];
+                ScreenTile *tile = &tiles[y][x];
                 if (softwareRendering && !tile->needsRefresh) {
                     continue; // software rendering does not use double-buffering, so the tile is still on screen
                 }
@@ -680,6 +959,13 @@ void updateScreen() {
                     dest.y = y * outputHeight / ROWS;
 
                     // paint the background
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+                    if (batching) {
+                        SDL_Color color = {round(2.55 * tile->backRed), round(2.55 * tile->backGreen), round(2.55 * tile->backBlue), 255};
+                        addQuad(quads++, &dest, color, NULL, 0);
+                        continue;
+                    }
+#endif
                     if (SDL_SetRenderDrawColor(renderer,
                         round(2.55 * tile->backRed),
                         round(2.55 * tile->backGreen),
@@ -713,6 +999,13 @@ void updateScreen() {
                     dest.y = y * outputHeight / ROWS;
 
                     // blend the foreground
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+                    if (batching) {
+                        SDL_Color color = {round(2.55 * tile->foreRed), round(2.55 * tile->foreGreen), round(2.55 * tile->foreBlue), 255};
+                        addQuad(quads++, &dest, color, &src, step);
+                        continue;
+                    }
+#endif
                     if (SDL_SetTextureColorMod(Textures[step],
                         round(2.55 * tile->foreRed),
                         round(2.55 * tile->foreGreen),
@@ -721,6 +1014,15 @@ void updateScreen() {
                 }
             }
         }
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        if (batching && !drawBatch(renderer, (step < 0 ? NULL : Textures[step]), quads)) {
+            // this renderer can't draw geometry: redo this step (and all future ones) tile by tile
+            fprintf(stderr, "SDL_RenderGeometry failed (%s), drawing tiles one by one\n", SDL_GetError());
+            batching = batchedRendering = false;
+            step--;
+        }
+#endif
     }
 
     SDL_RenderPresent(renderer);
@@ -728,9 +1030,158 @@ void updateScreen() {
     // the screen is now up to date
     for (int y = 0; y < ROWS; y++) {
         for (int x = 0; x < COLS; x++) {
-            screenTiles[y][x].needsRefresh = 0;
+            tiles[y][x].needsRefresh = 0;
+        }
+    }
+}
+
+
+/// Reads back what the renderer last drew.
+static SDL_Surface *readScreen(SDL_Renderer *renderer) {
+    // get its size
+    int outputWidth, outputHeight;
+    if (SDL_GetRendererOutputSize(renderer, &outputWidth, &outputHeight) < 0) sdlfatal(__FILE__, __LINE__);
+    if (outputWidth == 0 || outputHeight == 0) return NULL;
+
+    // take a screenshot
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, outputWidth, outputHeight, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!surface) sdlfatal(__FILE__, __LINE__);
+    if (SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_ARGB8888, surface->pixels, outputWidth * 4) < 0) sdlfatal(__FILE__, __LINE__);
+    return surface;
+}
+
+
+/// Takes the latest snapshot published by the game thread, if there is one, and marks the tiles
+/// that differ from what is on screen. Returns true if anything needs to be drawn.
+///
+/// Intermediate snapshots can be skipped, so tiles are compared with what was last drawn rather
+/// than relying on the game thread's `needsRefresh` flags.
+static boolean takeSnapshot(boolean outputResized) {
+    boolean changed = outputResized;
+
+    if (SDL_AtomicGet(&sharedSnapshot) & SNAPSHOT_FRESH) {
+        presentedSnapshot = SDL_AtomicSet(&sharedSnapshot, presentedSnapshot) & ~SNAPSHOT_FRESH;
+        for (int y = 0; y < ROWS; y++) {
+            for (int x = 0; x < COLS; x++) {
+                ScreenTile *tile = &snapshots[presentedSnapshot][y][x];
+                ScreenTile *drawn = &drawnTiles[y][x];
+                if (tile->charIndex != drawn->charIndex
+                    || tile->foreRed != drawn->foreRed || tile->foreGreen != drawn->foreGreen || tile->foreBlue != drawn->foreBlue
+                    || tile->backRed != drawn->backRed || tile->backGreen != drawn->backGreen || tile->backBlue != drawn->backBlue) {
+                    *drawn = *tile;
+                    drawn->needsRefresh = 1;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    if (outputResized) {
+        for (int y = 0; y < ROWS; y++) {
+            for (int x = 0; x < COLS; x++) {
+                drawnTiles[y][x].needsRefresh = 1;
+            }
         }
     }
+    return changed;
+}
+
+
+/// Body of the render thread: presents the latest snapshot at most `maxFramesPerSecond` times
+/// per second, and only when something changed.
+static int renderThreadMain(void *data) {
+    const Uint32 frameTicks = 1000 / max(1, maxFramesPerSecond);
+    Uint32 nextFrame = SDL_GetTicks();
+    int lastWidth = 0, lastHeight = 0;
+
+    while (!SDL_AtomicGet(&renderThreadQuit)) {
+        Uint32 now = SDL_GetTicks();
+        if ((Sint32)(nextFrame - now) > 0) {
+            SDL_Delay(nextFrame - now);
+            continue;
+        }
+        nextFrame = now + frameTicks;
+
+        SDL_LockMutex(rendererLock);
+
+        int outputWidth = 0, outputHeight = 0;
+        SDL_Renderer *renderer = SDL_GetRenderer(Win);
+        if (renderer && SDL_GetRendererOutputSize(renderer, &outputWidth, &outputHeight) < 0) sdlfatal(__FILE__, __LINE__);
+        boolean outputResized = (!renderer || outputWidth != lastWidth || outputHeight != lastHeight);
+        lastWidth = outputWidth;
+        lastHeight = outputHeight;
+
+        if (takeSnapshot(outputResized)) {
+            renderTiles(drawnTiles);
+        }
+
+        if (SDL_AtomicGet(&screenshotRequested)) {
+            renderer = SDL_GetRenderer(Win);
+            screenshot = (renderer ? readScreen(renderer) : NULL);
+            SDL_AtomicSet(&screenshotRequested, 0);
+            SDL_SemPost(screenshotTaken);
+        }
+
+        SDL_UnlockMutex(rendererLock);
+    }
+    return 0;
+}
+
+
+/// Starts presenting frames on a separate thread. From then on, the renderer belongs to that
+/// thread and `updateScreen` only publishes a snapshot of the screen buffer.
+static void startRenderThread() {
+    SDL_AtomicSet(&sharedSnapshot, 1);
+    SDL_AtomicSet(&renderThreadQuit, 0);
+    SDL_AtomicSet(&screenshotRequested, 0);
+    rendererLock = SDL_CreateMutex();
+    screenshotTaken = SDL_CreateSemaphore(0);
+    if (!rendererLock || !screenshotTaken) sdlfatal(__FILE__, __LINE__);
+
+    renderThread = SDL_CreateThread(renderThreadMain, "render", NULL);
+    if (!renderThread) sdlfatal(__FILE__, __LINE__);
+}
+
+
+/// Stops the render thread, if it is running. Must be called before SDL_Quit.
+void stopRenderThread() {
+    if (!renderThread) return;
+
+    SDL_AtomicSet(&renderThreadQuit, 1);
+    SDL_WaitThread(renderThread, NULL);
+    renderThread = NULL;
+}
+
+
+/// Prevents the render thread from touching the renderer while the game thread processes window
+/// events, which can resize or invalidate the renderer's output. Returns false if the render thread
+/// is busy and `blocking` is false. Does nothing (and returns true) without a render thread.
+boolean lockRenderer(boolean blocking) {
+    if (!renderThread) return true;
+    if (blocking) {
+        return SDL_LockMutex(rendererLock) == 0;
+    }
+    return SDL_TryLockMutex(rendererLock) == 0;
+}
+
+
+void unlockRenderer() {
+    if (renderThread) SDL_UnlockMutex(rendererLock);
+}
+
+
+/// Draws everything on screen, or, with a render thread, hands a copy of the screen buffer over
+/// to it. Publishing never waits for the render thread, which only ever sees the latest snapshot.
+void updateScreen() {
+    if (!Win) return;
+
+    if (renderThread) {
+        memcpy(snapshots[publishedSnapshot], screenTiles, sizeof(screenTiles));
+        publishedSnapshot = SDL_AtomicSet(&sharedSnapshot, publishedSnapshot | SNAPSHOT_FRESH) & ~SNAPSHOT_FRESH;
+        return;
+    }
+
+    renderTiles(screenTiles);
 }
 
 
@@ -764,8 +1215,12 @@ void resizeWindow(int width, int height) {
         if (!icon) imgfatal(__FILE__, __LINE__);
         SDL_SetWindowIcon(Win, icon);
         SDL_FreeSurface(icon);
+
+        if (renderThreadEnabled) startRenderThread();
     }
 
+    lockRenderer(true);
+
     if (fullScreen) {
         if (!(SDL_GetWindowFlags(Win) & SDL_WINDOW_FULLSCREEN_DESKTOP)) {
             // switch to fullscreen mode
@@ -787,6 +1242,7 @@ void resizeWindow(int width, int height) {
     }
 
     SDL_GetWindowSize(Win, &windowWidth, &windowHeight);
+    unlockRenderer();
     refreshScreen();
     updateScreen();
 }
@@ -795,18 +1251,75 @@ void resizeWindow(int width, int height) {
 SDL_Surface *captureScreen() {
     if (!Win) return NULL;
 
+    if (renderThread) {
+        // the renderer belongs to the render thread, so ask it to read the pixels
+        updateScreen();
+        SDL_AtomicSet(&screenshotRequested, 1);
+        SDL_SemWait(screenshotTaken);
+        SDL_Surface *surface = screenshot;
+        screenshot = NULL;
+        return surface;
+    }
+
     // get the renderer
     SDL_Renderer *renderer = SDL_GetRenderer(Win);
     if (!renderer) return NULL;
 
-    // get its size
-    int outputWidth, outputHeight;
-    if (SDL_GetRendererOutputSize(renderer, &outputWidth, &outputHeight) < 0) sdlfatal(__FILE__, __LINE__);
-    if (outputWidth == 0 || outputHeight == 0) return NULL;
+    return readScreen(renderer);
+}
 
-    // take a screenshot
-    SDL_Surface *screenshot = SDL_CreateRGBSurfaceWithFormat(0, outputWidth, outputHeight, 32, SDL_PIXELFORMAT_ARGB8888);
-    if (!screenshot) sdlfatal(__FILE__, __LINE__);
-    if (SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_ARGB8888, screenshot->pixels, outputWidth * 4) < 0) sdlfatal(__FILE__, __LINE__);
-    return screenshot;
+
+/// Measures how long it takes to draw full frames, tile by tile and (if available) batched.
+/// Every tile changes on every frame, so this is the worst case for the software renderer.
+/// Run it with `SDL_VIDEODRIVER=dummy` and `--no-gpu` to measure the software renderer alone.
+void benchmarkRendering(int frames) {
+    static ScreenTile randomTiles[2][ROWS][COLS];
+    uint32_t seed = 1;
+
+    if (!Win) return;
+    stopRenderThread(); // we need to draw synchronously
+
+    // two frames of random tiles to alternate between, so that every tile changes every frame
+    for (int i = 0; i < 2; i++) {
+        for (int y = 0; y < ROWS; y++) {
+            for (int x = 0; x < COLS; x++) {
+                short values[7];
+                for (int v = 0; v < 7; v++) {
+                    seed = seed * 1103515245 + 12345;
+                    values[v] = (seed >> 16) % 101;
+                }
+                randomTiles[i][y][x] = (ScreenTile){
+                    .foreRed = values[0], .foreGreen = values[1], .foreBlue = values[2],
+                    .backRed = values[3], .backGreen = values[4], .backBlue = values[5],
+                    .charIndex = (seed >> 8) % (TILE_ROWS * TILE_COLS),
+                    .needsRefresh = 1
+                };
+            }
+        }
+    }
+
+    boolean wasBatched = batchedRendering;
+    for (int pass = 0; pass < 2; pass++) {
+        batchedRendering = (pass == 1);
+        if (pass == 1 && !wasBatched) {
+            printf("Batched rendering is not available (needs SDL 2.0.18)\n");
+            break;
+        }
+
+        Uint32 start = SDL_GetTicks();
+        for (int frame = 0; frame < frames; frame++) {
+            memcpy(screenTiles, randomTiles[frame % 2], sizeof(screenTiles));
+            renderTiles(screenTiles);
+        }
+        Uint32 elapsed = SDL_GetTicks() - start;
+
+        if (pass == 1 && !batchedRendering) {
+            printf("Batched rendering is not supported by this renderer\n");
+            break;
+        }
+        printf("%s (%s renderer): %d frames in %u ms, %.2f ms/frame\n",
+            pass == 0 ? "Tile by tile" : "Batched", softwareRendering ? "software" : "accelerated",
+            frames, (unsigned)elapsed, (double)elapsed / max(1, frames));
+    }
+    batchedRendering = wasBatched;
 }
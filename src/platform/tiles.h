@@ -10,5 +10,9 @@ void updateTile(int row, int column, short charIndex,
     short backRed, short backGreen, short backBlue);
 void updateScreen(void);
 SDL_Surface *captureScreen(void);
+void stopRenderThread(void);
+boolean lockRenderer(boolean blocking);
+void unlockRenderer(void);
+void benchmarkRendering(int frames);
 
 #endif
@@ -1,60 +1,35 @@
 import os
 import subprocess
 import argparse
-from concurrent.futures import ThreadPoolExecutor
 import sys
 
 def run_brogue_tests(directory, num_processes, extra_args):
     # Get the absolute path of the directory
     directory = os.path.abspath(directory)
 
-    # Get a list of files with the extension '.broguerec'
-    files = [file for file in os.listdir(directory) if file.endswith('.broguerec')]
-
-    result_futures = {}
-
-    # Create a ThreadPoolExecutor with the specified number of processes
-    with ThreadPoolExecutor(max_workers=num_processes) as executor:
-
-        # Submit the brogue command for each file
-        for file in files:
-            file_path = os.path.join(directory, file)
-            if extra_args:
-                command = f'./brogue {extra_args} -vn {file_path}'
-            else:
-                command = f'./brogue -vn {file_path}'
+    # brogue replays every recording in the directory itself, each in a process of its own,
+    # and prints a CSV line per recording followed by a summary
+    if extra_args:
+        command = f'./brogue {extra_args} --verify-recordings {directory} --jobs {num_processes}'
+    else:
+        command = f'./brogue --verify-recordings {directory} --jobs {num_processes}'
 
-            # Use executor.submit to run the command in a separate thread
-            result_futures[file_path] = executor.submit(run_command, command)
+    print(f"Running {command}")
+    result = subprocess.run(command, shell=True, capture_output=True, text=True)
+    print(result.stdout)
+    print(result.stderr)
 
-    # List to store the failed tests
-    failed_tests = []
-    
-    # Check if there were any failed tests
-    for file_path, result_future in result_futures.items():
-        this_result = result_future.result()
-        if this_result:
-            failed_tests.append((file_path, this_result))
+    # List the failed tests
+    failed_tests = [line for line in result.stdout.splitlines()[1:] if '",passed,' not in line]
 
-    if failed_tests:
+    if result.returncode or failed_tests:
         print("Test run failure, failed tests:")
-        for file_path, result in failed_tests:
-            print(f"{file_path}:{result}")
+        for line in failed_tests:
+            print(line)
         sys.exit(1)
     else:
         print("Test run successful")
 
-def run_command(command):
-    # Run the command using subprocess.run
-    print(f"Running {command}")
-    result = subprocess.run(command, shell=True, capture_output=True, text=True)
-
-    # Print the command output
-    print(f"Results of {command}:\n{result.stdout}")
-
-    # Return the exit code
-    return result.returncode
-
 def main():
     # Create the argument parser
     parser = argparse.ArgumentParser(description='Brogue Test Runner')
@@ -69,4 +44,4 @@ def main():
     run_brogue_tests(args.directory, args.num_processes, args.extra_args)
 
 if __name__ == '__main__':
-    main()
\ No newline at end of file
+    main()